@@ -1,6 +1,8 @@
 #include <stdio.h>
 #include <stdlib.h>
 
+#include "../5/heap.h"
+
 #define PEASANT 0x08
 #define WOLF	0x04
 #define GOAT	0x02
@@ -22,6 +24,7 @@ void make_adjacency_matrix(int graph[][16]);
 void print_graph(int graph[][16], int num);
 void save_graph(char* filename, int graph[][16], int num);
 void depth_first_search(int initial_state, int goal_state);
+void shortest_path_search(int graph[][16], int initial_state, int goal_state);
 
 
 
@@ -43,6 +46,9 @@ int main( int argc, char **argv)
 
 	// 깊이 우선 탐색
 	depth_first_search( 0, 15); // initial state, goal state
+
+	// 최단 경로 탐색 (인접 행렬, 힙을 이용한 다익스트라)
+	shortest_path_search( graph, 0, 15); // initial state, goal state
 	
 	return 0;
 }
@@ -285,3 +291,60 @@ void depth_first_search(int initial_state, int goal_state)
 
 	dfs_main(initial_state, goal_state, depth, visited);
 }
+
+////////////////////////////////////////////////////////////////////////////////
+// 최단 경로 탐색 (초기 상태 -> 목적 상태)
+// 인접 행렬의 간선 비용은 1 (강을 한번 건넘)
+// 거리가 가장 짧은 상태를 힙에서 꺼내고, 더 짧은 경로를 찾으면 decrease-key
+void shortest_path_search(int graph[][16], int initial_state, int goal_state)
+{
+	long long dist[16];
+	int prev[16];
+	int path[16];
+	int done[16] = { 0, };
+	HEAP* heap = heapCreate(16, 4, NULL, NULL);
+
+	for (int i = 0; i < 16; i++) {
+		dist[i] = -1;
+		prev[i] = -1;
+	}
+	dist[initial_state] = 0;
+	heapInsert(heap, 0, initial_state);
+
+	while (heapSize(heap) > 0) {
+		int state = heapDelete(heap, NULL);
+		done[state] = 1;
+		if (state == goal_state) break;
+
+		for (int next = 0; next < 16; next++) {
+			if (!graph[state][next] || done[next]) continue;
+			if (dist[next] < 0) {
+				dist[next] = dist[state] + 1;
+				prev[next] = state;
+				heapInsert(heap, dist[next], next);
+			}
+			else if (dist[state] + 1 < dist[next]) {
+				dist[next] = dist[state] + 1;
+				prev[next] = state;
+				heapDecreaseKey(heap, next, dist[next]);
+			}
+		}
+	}
+	heapDestroy(heap);
+
+	if (dist[goal_state] < 0) {
+		printf("Goal-state not reachable!\n");
+		return;
+	}
+
+	// 목적 상태에서 거꾸로 따라간 경로를 차례로 출력
+	int depth = 0;
+	for (int state = goal_state; state != -1; state = prev[state]) path[depth++] = state;
+	printf("Shortest path (%lld moves)\n", dist[goal_state]);
+	for (int i = 0, j = depth - 1; i < j; i++, j--) {
+		int temp = path[i];
+		path[i] = path[j];
+		path[j] = temp;
+	}
+	print_path(path, depth - 1);
+}
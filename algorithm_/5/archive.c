@@ -0,0 +1,875 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <limits.h>
+#include <errno.h>
+#include <dirent.h>
+#include <sys/stat.h>
+
+#include "huffman.h"
+#include "archive.h"
+#include "parallel.h"
+#include "crc32c.h"
+
+// 한번에 압축하는 파일 수 (스레드 수의 배수)와 원본 크기의 합, 메모리 사용량을 제한
+#define BATCH_PER_THREAD	64
+#define BATCH_BYTES			((long long)1 << 28)
+
+// 조각 헤더의 크기 (압축 크기, CRC32C)
+#define CHUNK_HEADER( checksum)	((checksum) ? 8 : 4)
+
+// 아카이브에 넣을 파일 목록 (list_archive_files에서 늘려감)
+typedef struct
+{
+	tArchiveFile	*files;
+	int				count;
+	int				capacity;
+} tFileList;
+
+// 파일 하나의 압축 작업
+typedef struct
+{
+	const tArchiveFile	*file;		// 입력 파일
+	unsigned char		*out;		// 압축한 조각들 (작업에서 할당)
+	size_t				out_size;
+	long long			raw_size;	// 원본 크기
+	int					checksum;	// 조각마다 CRC32C 저장
+	int					error;
+} tMemberJob;
+
+// 목차의 멤버 하나
+typedef struct
+{
+	const char	*name;		// 멤버 이름 (NULL로 끝나지 않음)
+	size_t		name_len;
+	uint64_t	offset;		// 첫 조각의 위치
+	uint64_t	size;		// 조각들의 크기 합
+	uint64_t	raw_size;	// 원본 크기
+} tMember;
+
+// 조각 하나의 해제 작업
+typedef struct
+{
+	const unsigned char	*in;		// 조각의 compress_mem 형식 데이터
+	size_t				in_size;
+	unsigned char		*out;		// 출력 파일의 매핑 위치
+	size_t				out_size;
+	const unsigned char	*crc;		// 조각의 CRC32C (없으면 NULL)
+	int					error;		// 1 형식 오류, 2 CRC32C 불일치
+} tChunkJob;
+
+// 모든 멤버를 해제하는 작업
+typedef struct
+{
+	const unsigned char	*data;		// 아카이브
+	const tMember		*members;
+	size_t				chunk_size;
+	int					checksum;	// 조각마다 CRC32C가 있음
+	const char			*dir;		// 출력 디렉토리
+	int					*errors;	// 멤버별 결과 (0, -1, -2, -3)
+} tExtractAll;
+
+////////////////////////////////////////////////////////////////////////////////
+static void put_u16( unsigned char *p, unsigned v)
+{
+	p[0] = v;
+	p[1] = v >> 8;
+}
+
+static void put_u32( unsigned char *p, uint32_t v)
+{
+	int i;
+	for (i = 0; i < 4; i++) p[i] = v >> (8 * i);
+}
+
+static void put_u64( unsigned char *p, uint64_t v)
+{
+	int i;
+	for (i = 0; i < 8; i++) p[i] = v >> (8 * i);
+}
+
+static unsigned get_u16( const unsigned char *p)
+{
+	return p[0] | (p[1] << 8);
+}
+
+static uint32_t get_u32( const unsigned char *p)
+{
+	return p[0] | (p[1] << 8) | (p[2] << 16) | ((uint32_t)p[3] << 24);
+}
+
+static uint64_t get_u64( const unsigned char *p)
+{
+	return get_u32( p) | ((uint64_t)get_u32( p + 4) << 32);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// 멤버 이름(name, len 바이트)이 출력 디렉토리 밖을 가리키지 않는 상대 경로인지 검사
+// 빈 이름, 절대 경로, 빈 구성 요소("a//b"), "."과 ".." 구성 요소는 허용하지 않음
+// return value : 1 올바른 이름, 0 잘못된 이름
+static int valid_name( const char *name, size_t len)
+{
+	size_t i, begin = 0;
+
+	if (len == 0 || len > ARCHIVE_NAME_MAX) return 0;
+
+	for (i = 0; i <= len; i++)
+	{
+		if (i < len && name[i] == '\0') return 0;
+		if (i < len && name[i] != '/') continue;
+
+		// 구성 요소 name[begin, i)
+		if (i == begin) return 0;
+		if (name[begin] == '.' && (i - begin == 1 || (i - begin == 2 && name[begin + 1] == '.'))) return 0;
+		begin = i + 1;
+	}
+	return 1;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// 목록에 파일(path) 하나를 추가 (path를 복사)
+// return value : 0 성공, -1 이름이 잘못되었거나 메모리가 부족한 경우
+static int add_file( tFileList *list, const char *path, long long size)
+{
+	const char *name = path;
+	tArchiveFile *file;
+
+	// 멤버 이름 : 앞의 "/"와 "./"를 뺌
+	while (name[0] == '/' || (name[0] == '.' && name[1] == '/')) name += name[0] == '/' ? 1 : 2;
+	if (!valid_name( name, strlen( name)))
+	{
+		fprintf( stderr, "Error: invalid member name [%s]\n", path);
+		return -1;
+	}
+
+	if (list->count == list->capacity)
+	{
+		int capacity = list->capacity ? list->capacity * 2 : 64;
+		tArchiveFile *p = (tArchiveFile *)realloc( list->files, sizeof(tArchiveFile) * capacity);
+
+		if (p == NULL) return -1;
+		list->files = p;
+		list->capacity = capacity;
+	}
+
+	file = &list->files[list->count];
+	file->path = strdup( path);
+	if (file->path == NULL) return -1;
+	file->name = file->path + (name - path);
+	file->size = size;
+	list->count++;
+	return 0;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+static int compare_names( const void *a, const void *b)
+{
+	return strcmp( *(char * const *)a, *(char * const *)b);
+}
+
+// 목차의 멤버 이름 비교 (멤버 포인터의 배열을 정렬할 때)
+static int compare_members( const void *a, const void *b)
+{
+	const tMember *x = *(const tMember * const *)a;
+	const tMember *y = *(const tMember * const *)b;
+	int ret = memcmp( x->name, y->name, x->name_len < y->name_len ? x->name_len : y->name_len);
+
+	if (ret != 0) return ret;
+	return (x->name_len > y->name_len) - (x->name_len < y->name_len);
+}
+
+static int add_path( tFileList *list, const char *path);
+
+////////////////////////////////////////////////////////////////////////////////
+// 디렉토리(path) 아래의 항목을 이름 순으로 추가 (같은 디렉토리는 항상 같은 순서의 아카이브가 됨)
+// return value : 0 성공, -1 실패
+static int add_directory( tFileList *list, const char *path)
+{
+	DIR *dp = opendir( path);
+	struct dirent *entry;
+	char **names = NULL;
+	int count = 0, capacity = 0, ret = 0, i;
+	size_t len = strlen( path);
+
+	if (dp == NULL)
+	{
+		fprintf( stderr, "Error: cannot open directory [%s]\n", path);
+		return -1;
+	}
+
+	while ((entry = readdir( dp)) != NULL)
+	{
+		if (strcmp( entry->d_name, ".") == 0 || strcmp( entry->d_name, "..") == 0) continue;
+
+		if (count == capacity)
+		{
+			capacity = capacity ? capacity * 2 : 64;
+			char **p = (char **)realloc( names, sizeof(char *) * capacity);
+			if (p == NULL)
+			{
+				ret = -1;
+				break;
+			}
+			names = p;
+		}
+
+		// 디렉토리 경로 + "/" + 항목 이름
+		names[count] = (char *)malloc( len + strlen( entry->d_name) + 2);
+		if (names[count] == NULL)
+		{
+			ret = -1;
+			break;
+		}
+		sprintf( names[count], len > 0 && path[len - 1] == '/' ? "%s%s" : "%s/%s", path, entry->d_name);
+		count++;
+	}
+	closedir( dp);
+
+	if (ret == 0) qsort( names, count, sizeof(char *), compare_names);
+	for (i = 0; i < count; i++)
+	{
+		if (ret == 0 && add_path( list, names[i]) < 0) ret = -1;
+		free( names[i]);
+	}
+	free( names);
+	return ret;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// 목록 파일(path, "-"이면 표준 입력)의 각 줄(경로)을 추가 (빈 줄은 건너뜀, 줄 앞의 '@'는 목록 파일이 아님)
+// return value : 0 성공, -1 실패
+static int add_list_file( tFileList *list, const char *path)
+{
+	FILE *fp = strcmp( path, "-") == 0 ? stdin : fopen( path, "r");
+	char line[ARCHIVE_NAME_MAX + 2];
+	int ret = 0;
+
+	if (fp == NULL)
+	{
+		fprintf( stderr, "Error: cannot open file [%s]\n", path);
+		return -1;
+	}
+
+	while (ret == 0 && fgets( line, sizeof(line), fp) != NULL)
+	{
+		size_t len = strlen( line);
+
+		if (len > 0 && line[len - 1] == '\n') line[--len] = '\0';
+		else if (!feof( fp))
+		{
+			fprintf( stderr, "Error: too long path in [%s]\n", path);
+			ret = -1;
+			break;
+		}
+		if (len > 0 && line[len - 1] == '\r') line[--len] = '\0';
+		if (len > 0 && add_path( list, line) < 0) ret = -1;
+	}
+	if (ferror( fp)) ret = -1;
+	if (fp != stdin) fclose( fp);
+	return ret;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// 경로(path)를 목록에 추가 : 일반 파일, 디렉토리(하위 전체)
+// 일반 파일이나 디렉토리가 아닌 것(장치, 소켓 등)은 건너뜀
+// return value : 0 성공, -1 실패
+static int add_path( tFileList *list, const char *path)
+{
+	struct stat st;
+
+	if (stat( path, &st) < 0)
+	{
+		fprintf( stderr, "Error: cannot open file [%s]\n", path);
+		return -1;
+	}
+	if (S_ISDIR( st.st_mode)) return add_directory( list, path);
+	if (S_ISREG( st.st_mode)) return add_file( list, path, st.st_size);
+	return 0;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// 경로(paths, npaths개)를 아카이브에 넣을 파일 목록으로 펼침
+// 디렉토리는 하위의 일반 파일 전체, "@목록파일"은 목록파일의 각 줄 ("@-"이면 표준 입력)
+// return value : 파일 목록 (free_archive_files로 해제), 열 수 없는 경로나 이름이 잘못된 경로, 같은 이름의 파일이 있는 경우 NULL
+tArchiveFile *list_archive_files( char **paths, int npaths, int *count)
+{
+	tFileList list = { NULL, 0, 0 };
+	int i;
+
+	for (i = 0; i < npaths; i++)
+	{
+		int ret = paths[i][0] == '@' ? add_list_file( &list, paths[i] + 1) : add_path( &list, paths[i]);
+
+		if (ret < 0)
+		{
+			free_archive_files( list.files, list.count);
+			*count = 0;
+			return NULL;
+		}
+	}
+
+	// 같은 이름의 멤버가 둘이면 해제할 때 같은 파일에 겹쳐 쓰고 이름으로 찾을 수 없으므로 허용하지 않음
+	if (list.count > 1)
+	{
+		const char **names = (const char **)malloc( sizeof(char *) * list.count);
+		int ret = names == NULL ? -1 : 0;
+
+		for (i = 0; i < list.count && ret == 0; i++) names[i] = list.files[i].name;
+		if (ret == 0) qsort( names, list.count, sizeof(char *), compare_names);
+		for (i = 1; i < list.count && ret == 0; i++)
+		{
+			if (strcmp( names[i - 1], names[i]) == 0)
+			{
+				fprintf( stderr, "Error: duplicate member name [%s]\n", names[i]);
+				ret = -1;
+			}
+		}
+		free( names);
+
+		if (ret < 0)
+		{
+			free_archive_files( list.files, list.count);
+			*count = 0;
+			return NULL;
+		}
+	}
+
+	// 파일이 없어도 빈 아카이브를 만들 수 있도록 NULL이 아닌 목록을 돌려줌
+	if (list.files == NULL) list.files = (tArchiveFile *)malloc( sizeof(tArchiveFile));
+	*count = list.count;
+	return list.files;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// list_archive_files 함수로 만든 목록을 해제
+void free_archive_files( tArchiveFile *files, int count)
+{
+	int i;
+
+	for (i = 0; i < count; i++) free( files[i].path);
+	free( files);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// index번째 파일을 압축 (parallel_for에서 호출)
+// 파일을 메모리에 올려 ARCHIVE_CHUNK_SIZE 크기의 조각마다 [압축 크기, (CRC32C), compress_mem 형식]을 출력
+static void encode_member( void *arg, int index)
+{
+	tMemberJob *job = &((tMemberJob *)arg)[index];
+	int hdr = CHUNK_HEADER( job->checksum);
+	tInput input;
+	tCodec *codec;
+	size_t pos, cap = 0;
+
+	if (open_input( job->file->path, &input) < 0)
+	{
+		job->error = 1;
+		return;
+	}
+	job->raw_size = input.size;
+
+	for (pos = 0; pos < input.size; pos += ARCHIVE_CHUNK_SIZE)
+	{
+		size_t n = input.size - pos < ARCHIVE_CHUNK_SIZE ? input.size - pos : ARCHIVE_CHUNK_SIZE;
+		cap += hdr + compress_bound( n);
+	}
+
+	codec = create_codec();
+	job->out = (unsigned char *)malloc( cap ? cap : 1);
+	job->out_size = 0;
+	if (codec == NULL || job->out == NULL) job->error = 1;
+
+	for (pos = 0; pos < input.size && !job->error; pos += ARCHIVE_CHUNK_SIZE)
+	{
+		size_t n = input.size - pos < ARCHIVE_CHUNK_SIZE ? input.size - pos : ARCHIVE_CHUNK_SIZE;
+		unsigned char *p = job->out + job->out_size;
+		long long ret = compress_mem( codec, input.data + pos, n, p + hdr, cap - job->out_size - hdr);
+
+		if (ret < 0) job->error = 1;
+		else
+		{
+			put_u32( p, ret);
+			if (job->checksum) put_u32( p + 4, crc32c( 0, input.data + pos, n));
+			job->out_size += hdr + ret;
+		}
+	}
+
+	destroy_codec( codec);
+	close_input( &input);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// 파일 목록(files, count개)을 파일마다 압축하여 출력 파일(outfp)에 아카이브로 저장
+// 원본 크기의 합이 BATCH_BYTES를 넘지 않을 만큼씩 병렬로 압축하여 목록 순서대로 출력
+// return value : 출력한 바이트 수, 실패한 경우 -1
+long long archive_encoding( const tArchiveFile *files, int count, FILE *outfp, int nthreads, int checksum, long long *num_bytes)
+{
+	unsigned char buf[ARCHIVE_FOOTER_SIZE + 26];
+	int batch_size = nthreads * BATCH_PER_THREAD;
+	uint64_t *offsets, *sizes, *raw_sizes;
+	tMemberJob *jobs;
+	long long written = 0;
+	int first, i, error = 0;
+
+	*num_bytes = 0;
+	offsets = (uint64_t *)malloc( sizeof(uint64_t) * 3 * (count + 1));
+	jobs = (tMemberJob *)malloc( sizeof(tMemberJob) * batch_size);
+	if (offsets == NULL || jobs == NULL)
+	{
+		free( offsets);
+		free( jobs);
+		return -1;
+	}
+	sizes = offsets + count + 1;
+	raw_sizes = sizes + count + 1;
+
+	// 파일 헤더
+	memcpy( buf, ARCHIVE_MAGIC, 2);
+	buf[2] = ARCHIVE_VERSION;
+	buf[3] = checksum ? ARCHIVE_CHECKSUM : 0;
+	put_u32( buf + 4, ARCHIVE_CHUNK_SIZE);
+	fwrite( buf, 1, ARCHIVE_HEADER_SIZE, outfp);
+	written += ARCHIVE_HEADER_SIZE;
+
+	// 멤버 : 파일 수와 원본 크기로 나눈 묶음마다 병렬로 압축하여 순서대로 출력
+	for (first = 0; first < count && !error; )
+	{
+		long long batch_bytes = 0;
+		int n = 0;
+
+		while (first + n < count && n < batch_size && (n == 0 || batch_bytes + files[first + n].size <= BATCH_BYTES))
+		{
+			jobs[n].file = &files[first + n];
+			jobs[n].out = NULL;
+			jobs[n].raw_size = 0;
+			jobs[n].checksum = checksum;
+			jobs[n].error = 0;
+			batch_bytes += files[first + n].size;
+			n++;
+		}
+
+		parallel_for( n, nthreads, encode_member, jobs);
+
+		for (i = 0; i < n; i++)
+		{
+			if (jobs[i].error)
+			{
+				if (!error) fprintf( stderr, "Error: cannot read file [%s]\n", jobs[i].file->path);
+				error = 1;
+			}
+			else if (!error)
+			{
+				offsets[first + i] = written;
+				sizes[first + i] = jobs[i].out_size;
+				raw_sizes[first + i] = jobs[i].raw_size;
+				fwrite( jobs[i].out, 1, jobs[i].out_size, outfp);
+				written += jobs[i].out_size;
+				*num_bytes += jobs[i].raw_size;
+			}
+			free( jobs[i].out);
+		}
+		first += n;
+	}
+
+	if (!error)
+	{
+		// 목차
+		uint64_t toc_offset = written;
+		for (i = 0; i < count; i++)
+		{
+			size_t len = strlen( files[i].name);
+
+			put_u64( buf, offsets[i]);
+			put_u64( buf + 8, sizes[i]);
+			put_u64( buf + 16, raw_sizes[i]);
+			put_u16( buf + 24, len);
+			fwrite( buf, 1, 26, outfp);
+			fwrite( files[i].name, 1, len, outfp);
+			written += 26 + len;
+		}
+
+		// 파일 끝
+		put_u64( buf, toc_offset);
+		put_u32( buf + 8, count);
+		memcpy( buf + 12, ARCHIVE_INDEX_MAGIC, 4);
+		fwrite( buf, 1, ARCHIVE_FOOTER_SIZE, outfp);
+		written += ARCHIVE_FOOTER_SIZE;
+
+		if (ferror( outfp)) error = 1;
+	}
+
+	free( jobs);
+	free( offsets);
+
+	return error ? -1 : written;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// 아카이브의 파일 헤더와 파일 끝을 확인하고 목차를 읽음
+// chunk_size : 조각 크기를 저장, checksum : 조각마다 CRC32C가 있는지 저장, count : 멤버 수를 저장
+// return value : 멤버 배열 (free로 해제), 형식이 맞지 않는 경우 NULL
+static tMember *read_toc( const unsigned char *data, size_t size, size_t *chunk_size, int *checksum, int *count)
+{
+	const unsigned char *footer, *p, *end;
+	uint64_t toc_offset;
+	tMember *members;
+	int i;
+
+	if (size < ARCHIVE_HEADER_SIZE + ARCHIVE_FOOTER_SIZE
+		|| memcmp( data, ARCHIVE_MAGIC, 2) != 0 || data[2] != ARCHIVE_VERSION) return NULL;
+	if (data[3] & ~ARCHIVE_CHECKSUM) return NULL; // 모르는 플래그
+	*checksum = data[3] & ARCHIVE_CHECKSUM;
+	*chunk_size = get_u32( data + 4);
+	if (*chunk_size == 0 || *chunk_size > CODEC_MAX_SIZE) return NULL;
+
+	footer = data + size - ARCHIVE_FOOTER_SIZE;
+	if (memcmp( footer + 12, ARCHIVE_INDEX_MAGIC, 4) != 0) return NULL;
+	toc_offset = get_u64( footer);
+	*count = get_u32( footer + 8);
+	if (toc_offset < ARCHIVE_HEADER_SIZE || toc_offset > size - ARCHIVE_FOOTER_SIZE
+		|| *count < 0 || (uint64_t)*count > (size - ARCHIVE_FOOTER_SIZE - toc_offset) / 26) return NULL;
+
+	members = (tMember *)malloc( sizeof(tMember) * (*count + 1));
+	if (members == NULL) return NULL;
+
+	p = data + toc_offset;
+	end = footer;
+	for (i = 0; i < *count; i++)
+	{
+		tMember *m = &members[i];
+
+		if (end - p < 26) break;
+		m->offset = get_u64( p);
+		m->size = get_u64( p + 8);
+		m->raw_size = get_u64( p + 16);
+		m->name_len = get_u16( p + 24);
+		m->name = (const char *)p + 26;
+		p += 26;
+
+		if ((size_t)(end - p) < m->name_len || !valid_name( m->name, m->name_len)) break;
+		if (m->offset < ARCHIVE_HEADER_SIZE || m->offset > toc_offset || m->size > toc_offset - m->offset) break;
+		p += m->name_len;
+	}
+	if (i < *count || p != end)
+	{
+		free( members);
+		return NULL;
+	}
+
+	// 같은 이름의 멤버가 있으면 형식 오류
+	if (*count > 1)
+	{
+		const tMember **sorted = (const tMember **)malloc( sizeof(tMember *) * *count);
+		int error = sorted == NULL;
+
+		for (i = 0; i < *count && !error; i++) sorted[i] = &members[i];
+		if (!error) qsort( sorted, *count, sizeof(tMember *), compare_members);
+		for (i = 1; i < *count && !error; i++)
+		{
+			if (compare_members( &sorted[i - 1], &sorted[i]) == 0) error = 1;
+		}
+		free( sorted);
+
+		if (error)
+		{
+			free( members);
+			return NULL;
+		}
+	}
+	return members;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// 이름이 name인 멤버를 찾음
+// return value : 멤버 번호, 없는 경우 -1
+static int find_member( const tMember *members, int count, const char *name)
+{
+	size_t len = strlen( name);
+	int i;
+
+	for (i = 0; i < count; i++)
+	{
+		if (members[i].name_len == len && memcmp( members[i].name, name, len) == 0) return i;
+	}
+	return -1;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// 멤버(m)의 조각들을 차례로 해제하여 출력 파일(out)에 저장
+// 출력 파일이 매핑되어 있으면 제 위치에 직접 해제하고, 아니면 조각마다 출력
+// checksum : 1이면 조각마다 해제한 결과가 캐시에 있을 때 CRC32C를 확인
+// return value : 0 성공, -1 형식이 맞지 않는 경우, -2 출력 파일에 쓸 수 없는 경우, -3 CRC32C가 맞지 않는 경우
+static int decode_member( const unsigned char *data, const tMember *m, size_t chunk_size, int checksum, tOutput *out)
+{
+	int hdr = CHUNK_HEADER( checksum);
+	const unsigned char *p = data + m->offset;
+	uint64_t avail = m->size, pos = 0;
+	tCodec *codec = create_codec();
+	unsigned char *buf = out->data ? NULL : (unsigned char *)malloc( chunk_size);
+	int ret = 0;
+
+	if (codec == NULL || (out->data == NULL && buf == NULL)) ret = -1;
+	if (out->data != NULL && out->size != m->raw_size) ret = -1;
+
+	while (ret == 0 && avail > 0)
+	{
+		uint64_t csize = avail >= (uint64_t)hdr ? get_u32( p) : avail;
+		long long n = csize + hdr <= avail ? decompressed_size( p + hdr, csize) : -1;
+		unsigned char *dst = out->data ? out->data + pos : buf;
+
+		if (n <= 0 || (uint64_t)n > chunk_size || (uint64_t)n > m->raw_size - pos)
+		{
+			ret = -1;
+			break;
+		}
+		if (decompress_mem( codec, p + hdr, csize, dst, n) != n) ret = -1;
+		else if (checksum && crc32c( 0, dst, n) != get_u32( p + 4)) ret = -3;
+		else if (out->data == NULL && write_output( out, buf, n) < 0) ret = -2;
+
+		pos += n;
+		p += hdr + csize;
+		avail -= hdr + csize;
+	}
+	if (ret == 0 && pos != m->raw_size) ret = -1;
+	if (ret == 0 && out->data != NULL) out->pos = out->size;
+
+	free( buf);
+	destroy_codec( codec);
+	return ret;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// index번째 조각을 출력 파일의 매핑 위치에 해제 (parallel_for에서 호출)
+static void decode_chunk( void *arg, int index)
+{
+	tChunkJob *job = &((tChunkJob *)arg)[index];
+	tCodec *codec = create_codec();
+
+	if (codec == NULL || decompressed_size( job->in, job->in_size) != (long long)job->out_size
+		|| decompress_mem( codec, job->in, job->in_size, job->out, job->out_size) != (long long)job->out_size) job->error = 1;
+	else if (job->crc && crc32c( 0, job->out, job->out_size) != get_u32( job->crc)) job->error = 2;
+	destroy_codec( codec);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// 메모리(data)에 올린 아카이브의 멤버 수
+// return value : 멤버 수, -1 형식이 맞지 않는 경우
+int archive_count( const unsigned char *data, size_t size)
+{
+	size_t chunk_size;
+	int checksum, count;
+	tMember *members = read_toc( data, size, &chunk_size, &checksum, &count);
+
+	if (members == NULL) return -1;
+	free( members);
+	return count;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// 메모리(data)에 올린 아카이브에서 이름이 name인 멤버의 원본 크기
+// return value : 원본 바이트 수, -1 형식이 맞지 않거나 멤버가 없는 경우
+long long archive_member_size( const unsigned char *data, size_t size, const char *name)
+{
+	size_t chunk_size;
+	int checksum, count, i;
+	long long raw_size = -1;
+	tMember *members = read_toc( data, size, &chunk_size, &checksum, &count);
+
+	if (members == NULL) return -1;
+	i = find_member( members, count, name);
+	if (i >= 0 && members[i].raw_size <= (uint64_t)LLONG_MAX) raw_size = members[i].raw_size;
+	free( members);
+	return raw_size;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// 메모리(data)에 올린 아카이브에서 이름이 name인 멤버를 해제하여 출력 파일(out)에 저장
+// 출력 파일이 매핑되어 있으면 조각의 위치를 먼저 찾고 nthreads개의 스레드가 조각을 나누어 제 위치에 해제
+// return value : 0 성공, -1 형식이 맞지 않거나 멤버가 없는 경우, -2 출력 파일에 쓸 수 없는 경우, -3 CRC32C가 맞지 않는 경우
+int archive_extract_member( const unsigned char *data, size_t size, const char *name, tOutput *out, int nthreads)
+{
+	size_t chunk_size;
+	int checksum, count, i, nchunks, hdr, ret = 0;
+	tMember *members = read_toc( data, size, &chunk_size, &checksum, &count);
+	tMember *m;
+	tChunkJob *jobs;
+
+	if (members == NULL) return -1;
+	i = find_member( members, count, name);
+	if (i < 0)
+	{
+		free( members);
+		return -1;
+	}
+	m = &members[i];
+
+	// 매핑하지 않은 출력 (표준 출력 등)이나 조각이 하나뿐인 멤버 : 차례로 해제
+	if (out->data == NULL || m->raw_size <= chunk_size)
+	{
+		ret = decode_member( data, m, chunk_size, checksum, out);
+		free( members);
+		return ret;
+	}
+
+	if (out->size != m->raw_size)
+	{
+		free( members);
+		return -1;
+	}
+
+	// 조각의 위치 : 각 조각은 마지막 조각을 빼고 chunk_size 바이트를 해제함
+	nchunks = (m->raw_size + chunk_size - 1) / chunk_size;
+	hdr = CHUNK_HEADER( checksum);
+	jobs = (tChunkJob *)malloc( sizeof(tChunkJob) * nchunks);
+	if (jobs == NULL) ret = -1;
+	else
+	{
+		const unsigned char *p = data + m->offset;
+		uint64_t avail = m->size;
+
+		for (i = 0; i < nchunks && ret == 0; i++)
+		{
+			uint64_t begin = (uint64_t)i * chunk_size;
+			uint64_t csize = avail >= (uint64_t)hdr ? get_u32( p) : avail;
+
+			if (csize + hdr > avail) ret = -1;
+			jobs[i].in = p + hdr;
+			jobs[i].in_size = csize;
+			jobs[i].out = out->data + begin;
+			jobs[i].out_size = m->raw_size - begin < chunk_size ? m->raw_size - begin : chunk_size;
+			jobs[i].crc = checksum ? p + 4 : NULL;
+			jobs[i].error = 0;
+			p += hdr + csize;
+			avail -= hdr + csize;
+		}
+		if (ret == 0 && avail != 0) ret = -1;
+
+		if (ret == 0) parallel_for( nchunks, nthreads, decode_chunk, jobs);
+		for (i = 0; i < nchunks && ret == 0; i++)
+		{
+			if (jobs[i].error) ret = jobs[i].error == 2 ? -3 : -1;
+		}
+		if (ret == 0) out->pos = out->size;
+	}
+
+	free( jobs);
+	free( members);
+	return ret;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// 경로(path)의 상위 디렉토리들을 만듦 (이미 있으면 그대로 둠)
+// return value : 0 성공, -1 실패
+static int make_parent_dirs( char *path)
+{
+	char *p;
+
+	for (p = strchr( path + 1, '/'); p != NULL; p = strchr( p + 1, '/'))
+	{
+		*p = '\0';
+		int ret = mkdir( path, 0777);
+		*p = '/';
+		if (ret < 0 && errno != EEXIST) return -1;
+	}
+	return 0;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// 출력 디렉토리(dir) 아래의 멤버(m) 경로 (free로 해제)
+static char *member_path( const char *dir, const tMember *m)
+{
+	size_t len = strlen( dir);
+	char *path = (char *)malloc( len + m->name_len + 2);
+
+	if (path == NULL) return NULL;
+	memcpy( path, dir, len);
+	if (len == 0 || dir[len - 1] != '/') path[len++] = '/';
+	memcpy( path + len, m->name, m->name_len);
+	path[len + m->name_len] = '\0';
+	return path;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// index번째 멤버를 출력 디렉토리에 해제 (parallel_for에서 호출)
+static void extract_job( void *arg, int index)
+{
+	tExtractAll *all = arg;
+	const tMember *m = &all->members[index];
+	char *path = member_path( all->dir, m);
+	tOutput out;
+	int ret;
+
+	if (path == NULL || open_output( path, m->raw_size, &out) < 0)
+	{
+		if (path) fprintf( stderr, "Error: cannot open file [%s]\n", path);
+		all->errors[index] = -2;
+		free( path);
+		return;
+	}
+
+	ret = decode_member( all->data, m, all->chunk_size, all->checksum, &out);
+	if (close_output( &out) < 0 && ret == 0) ret = -2;
+	if (ret == -2) fprintf( stderr, "Error: cannot write file [%s]\n", path);
+	if (ret == -3) fprintf( stderr, "Error: checksum mismatch [%s]\n", path);
+	all->errors[index] = ret;
+	free( path);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// 메모리(data)에 올린 아카이브의 모든 멤버를 디렉토리(dir) 아래에 해제
+// 필요한 디렉토리를 먼저 모두 만든 다음 nthreads개의 스레드가 멤버를 나누어 해제
+// return value : 0 성공, -1 형식이 맞지 않는 경우, -2 출력 파일을 만들거나 쓸 수 없는 경우, -3 CRC32C가 맞지 않는 경우
+int archive_extract_all( const unsigned char *data, size_t size, const char *dir, int nthreads, long long *num_bytes)
+{
+	tExtractAll all;
+	size_t chunk_size;
+	int checksum, count, i, ret = 0;
+	tMember *members = read_toc( data, size, &chunk_size, &checksum, &count);
+
+	*num_bytes = 0;
+	if (members == NULL) return -1;
+
+	if (mkdir( dir, 0777) < 0 && errno != EEXIST)
+	{
+		fprintf( stderr, "Error: cannot create directory [%s]\n", dir);
+		free( members);
+		return -2;
+	}
+
+	// 디렉토리 : 여러 스레드에서 같은 디렉토리를 만들지 않도록 미리 만듦
+	for (i = 0; i < count && ret == 0; i++)
+	{
+		char *path = member_path( dir, &members[i]);
+
+		if (path == NULL || make_parent_dirs( path) < 0)
+		{
+			if (path) fprintf( stderr, "Error: cannot create directory for [%s]\n", path);
+			ret = -2;
+		}
+		free( path);
+	}
+
+	all.data = data;
+	all.members = members;
+	all.chunk_size = chunk_size;
+	all.checksum = checksum;
+	all.dir = dir;
+	all.errors = (int *)calloc( count + 1, sizeof(int));
+	if (all.errors == NULL) ret = -2;
+
+	if (ret == 0)
+	{
+		parallel_for( count, nthreads, extract_job, &all);
+
+		for (i = 0; i < count; i++)
+		{
+			if ((all.errors[i] == -1 || all.errors[i] == -3) && ret == 0) ret = all.errors[i];
+			else if (all.errors[i] == -2) ret = -2;
+			else if (all.errors[i] == 0) *num_bytes += members[i].raw_size;
+		}
+	}
+
+	free( all.errors);
+	free( members);
+	return ret;
+}
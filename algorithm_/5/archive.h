@@ -0,0 +1,76 @@
+#ifndef ARCHIVE_H
+#define ARCHIVE_H
+
+#include <stdio.h>
+#include <stdint.h>
+
+#include "huffman.h"
+
+////////////////////////////////////////////////////////////////////////////////
+// 아카이브 형식 : 여러 파일을 파일마다 따로 압축하여 하나의 파일로 저장
+// 파일(멤버)끼리 독립적이므로 여러 스레드에서 동시에 압축/해제할 수 있음
+//
+// [파일 헤더]   "HA", 버전(1), 플래그(1), 조각 크기(4)
+// [멤버] ...    조각 ... (원본을 조각 크기로 나눔, 빈 파일은 조각이 없음)
+// [조각]        압축 크기(4), [CRC32C(4)], compress_mem 형식 [원본 크기(4), 비트 수(4), 코드 길이, 비트열]
+//               CRC32C는 플래그에 ARCHIVE_CHECKSUM을 표시한 경우에만 있음 (조각 원본의 체크섬)
+// [목차]        멤버별 파일 내 위치(8), 압축 크기(8), 원본 크기(8), 이름 길이(2), 이름 ...
+// [파일 끝]     목차의 위치(8), 멤버 수(4), "HAIX"
+// 정수는 모두 little-endian, 이름은 '/'로 구분한 상대 경로
+
+#define ARCHIVE_MAGIC		"HA"
+#define ARCHIVE_INDEX_MAGIC	"HAIX"
+#define ARCHIVE_VERSION		1
+
+#define ARCHIVE_CHECKSUM	0x01	// 조각마다 CRC32C 저장 (파일 헤더의 플래그)
+
+#define ARCHIVE_HEADER_SIZE	8		// 파일 헤더의 크기
+#define ARCHIVE_FOOTER_SIZE	16		// 파일 끝의 크기
+
+#define ARCHIVE_CHUNK_SIZE	(1 << 22)	// 조각 크기 (멤버 하나를 여러 스레드가 나누어 해제하는 단위)
+#define ARCHIVE_NAME_MAX	4096		// 멤버 이름의 최대 길이
+
+// 아카이브에 넣을 파일
+typedef struct
+{
+	char		*path;	// 파일 경로
+	const char	*name;	// 멤버 이름 (path에서 앞의 "/"와 "./"를 뺀 부분)
+	long long	size;	// 목록을 만들 때의 파일 크기
+} tArchiveFile;
+
+// 경로(paths, npaths개)를 아카이브에 넣을 파일 목록으로 펼침
+// 디렉토리는 하위의 일반 파일 전체, "@목록파일"은 목록파일의 각 줄 ("@-"이면 표준 입력)
+// count : 파일 수를 저장
+// return value : 파일 목록 (free_archive_files로 해제), 열 수 없는 경로나 이름이 잘못된 경로, 같은 이름의 파일이 있는 경우 NULL
+tArchiveFile *list_archive_files( char **paths, int npaths, int *count);
+
+// list_archive_files 함수로 만든 목록을 해제
+void free_archive_files( tArchiveFile *files, int count);
+
+// 파일 목록(files, count개)을 파일마다 압축하여 출력 파일(outfp)에 아카이브로 저장
+// nthreads개의 스레드가 파일을 나누어 압축하고, 출력은 목록 순서대로
+// checksum : 1이면 조각마다 원본의 CRC32C를 저장
+// num_bytes : 원본 바이트 수의 합을 저장
+// return value : 출력한 바이트 수, 실패한 경우 -1
+long long archive_encoding( const tArchiveFile *files, int count, FILE *outfp, int nthreads, int checksum, long long *num_bytes);
+
+// 메모리(data)에 올린 아카이브의 멤버 수
+// return value : 멤버 수, -1 형식이 맞지 않는 경우
+int archive_count( const unsigned char *data, size_t size);
+
+// 메모리(data)에 올린 아카이브에서 이름이 name인 멤버의 원본 크기
+// return value : 원본 바이트 수, -1 형식이 맞지 않거나 멤버가 없는 경우
+long long archive_member_size( const unsigned char *data, size_t size, const char *name);
+
+// 메모리(data)에 올린 아카이브에서 이름이 name인 멤버를 해제하여 출력 파일(out)에 저장
+// 출력 파일이 매핑되어 있으면 nthreads개의 스레드가 조각을 나누어 제 위치에 직접 해제하고, 아니면 조각 순서대로 출력
+// return value : 0 성공, -1 형식이 맞지 않거나 멤버가 없는 경우, -2 출력 파일에 쓸 수 없는 경우, -3 CRC32C가 맞지 않는 경우
+int archive_extract_member( const unsigned char *data, size_t size, const char *name, tOutput *out, int nthreads);
+
+// 메모리(data)에 올린 아카이브의 모든 멤버를 디렉토리(dir) 아래에 해제 (필요한 디렉토리를 만듦)
+// nthreads개의 스레드가 멤버를 나누어 해제
+// num_bytes : 해제한 원본 바이트 수의 합을 저장
+// return value : 0 성공, -1 형식이 맞지 않는 경우, -2 출력 파일을 만들거나 쓸 수 없는 경우, -3 CRC32C가 맞지 않는 경우
+int archive_extract_all( const unsigned char *data, size_t size, const char *dir, int nthreads, long long *num_bytes);
+
+#endif
@@ -0,0 +1,567 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <poll.h>
+#include <time.h>
+#include <unistd.h>
+
+#include "huffman.h"
+#include "block.h"
+#include "parallel.h"
+#include "crc32c.h"
+
+// 한번에 처리하는 블록 수 (스레드 수의 배수), 메모리 사용량을 제한
+#define BATCH_PER_THREAD	4
+
+// 블록 하나의 인코딩/디코딩 작업
+typedef struct
+{
+	const unsigned char	*in;		// 입력
+	size_t				in_size;
+	unsigned char		*out;		// 출력 (작업에서 할당, 디코딩은 출력 파일의 매핑 위치일 수 있음)
+	size_t				out_size;
+	int					error;		// 1 형식 오류, 2 CRC32C 불일치
+} tBlockJob;
+
+// 여러 블록의 작업 목록
+typedef struct
+{
+	tBlockJob	*jobs;
+	int			max_len;	// 코드 길이 제한
+	int			streams;	// 블록마다의 비트열 수
+	int			checksum;	// 블록마다 CRC32C 저장
+} tBatch;
+
+// 블록 헤더의 크기 (원본 크기, 비트열 크기, CRC32C)
+#define BLOCK_JOB_HEADER( batch)	((batch)->checksum ? 12 : 8)
+
+////////////////////////////////////////////////////////////////////////////////
+static void put_u32( unsigned char *p, uint32_t v)
+{
+	int i;
+	for (i = 0; i < 4; i++) p[i] = v >> (8 * i);
+}
+
+static void put_u64( unsigned char *p, uint64_t v)
+{
+	int i;
+	for (i = 0; i < 8; i++) p[i] = v >> (8 * i);
+}
+
+static uint32_t get_u32( const unsigned char *p)
+{
+	return p[0] | (p[1] << 8) | (p[2] << 16) | ((uint32_t)p[3] << 24);
+}
+
+static uint64_t get_u64( const unsigned char *p)
+{
+	return get_u32( p) | ((uint64_t)get_u32( p + 4) << 32);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// index번째 블록을 인코딩 (parallel_for에서 호출)
+// 블록의 빈도로 허프만 코드를 만들고 [원본 크기, 비트열 크기, (CRC32C), 코드 길이, 비트열]을 출력
+// CRC32C는 빈도를 센 직후 블록이 캐시에 있을 때 계산
+static void encode_job( void *arg, int index)
+{
+	tBatch *batch = arg;
+	tBlockJob *job = &batch->jobs[index];
+	long long ch_freq[256] = {0,};
+	unsigned char lengths[256];
+	tCode codes[256];
+	tTree *tree;
+	uint64_t nbits;
+	int hdr = BLOCK_JOB_HEADER( batch);
+	int n;
+	
+	count_chars( job->in, job->in_size, ch_freq);
+	uint32_t crc = batch->checksum ? crc32c( 0, job->in, job->in_size) : 0;
+	
+	tree = make_huffman_tree( ch_freq);
+	get_code_lengths( tree, lengths);
+	destroyTree( tree);
+	
+	if (batch->max_len > 0 && max_code_length( lengths) > batch->max_len
+		&& get_limited_code_lengths( ch_freq, batch->max_len, lengths) < 0)
+	{
+		job->error = 1;
+		return;
+	}
+	if (make_canonical_code( lengths, codes) < 0)
+	{
+		job->error = 1;
+		return;
+	}
+	
+	job->out = (unsigned char *)malloc( hdr + 257 + STREAMS_BOUND( job->in_size));
+	if (job->out == NULL)
+	{
+		job->error = 1;
+		return;
+	}
+	
+	put_u32( job->out, job->in_size);
+	if (batch->checksum) put_u32( job->out + 8, crc);
+	n = pack_code_lengths( lengths, job->out + hdr);
+	if (batch->streams == NUM_STREAMS)
+	{
+		size_t nbytes = encoding_streams( codes, job->in, job->in_size, job->out + hdr + n);
+		put_u32( job->out + 4, nbytes);
+		job->out_size = hdr + n + nbytes;
+	}
+	else
+	{
+		nbits = encoding_bits( codes, job->in, job->in_size, job->out + hdr + n);
+		put_u32( job->out + 4, nbits);
+		job->out_size = hdr + n + (nbits + 7) / 8;
+	}
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// index번째 블록을 디코딩 (parallel_for에서 호출)
+// CRC32C가 있으면 디코딩한 블록이 캐시에 있을 때 확인
+static void decode_job( void *arg, int index)
+{
+	tBatch *batch = arg;
+	tBlockJob *job = &batch->jobs[index];
+	unsigned char lengths[256];
+	const unsigned char *p = job->in;
+	size_t avail = job->in_size;
+	size_t nbytes;
+	int hdr = BLOCK_JOB_HEADER( batch);
+	int n, ret;
+	
+	if (job->error) return;
+	
+	// 매핑한 출력 파일에 직접 디코딩하는 경우 블록 크기가 맞아야 함
+	if (job->out != NULL && get_u32( p) != job->out_size)
+	{
+		job->error = 1;
+		return;
+	}
+	job->out_size = get_u32( p);
+	nbytes = get_u32( p + 4);
+	if (batch->streams != NUM_STREAMS) nbytes = (nbytes + 7) / 8; // 비트 수
+	
+	n = unpack_code_lengths( p + hdr, avail - hdr, lengths);
+	if (n < 0 || hdr + n + nbytes > avail || max_code_length( lengths) > batch->max_len)
+	{
+		job->error = 1;
+		return;
+	}
+	
+	if (job->out == NULL) job->out = (unsigned char *)malloc( job->out_size ? job->out_size : 1);
+	if (job->out == NULL)
+	{
+		job->error = 1;
+		return;
+	}
+	
+	if (batch->streams == NUM_STREAMS) ret = decoding_streams( lengths, p + hdr + n, nbytes, job->out, job->out_size);
+	else ret = decoding_mem( lengths, p + hdr + n, nbytes, job->out, job->out_size);
+	if (ret < 0) job->error = 1;
+	else if (batch->checksum && crc32c( 0, job->out, job->out_size) != get_u32( p + 8)) job->error = 2;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// 메모리(data)에 있는 텍스트를 block_size 크기의 블록으로 나누어 출력 파일(outfp)로 인코딩
+// nthreads개의 스레드가 블록을 나누어 인코딩하고, 출력은 블록 순서대로
+// return value : 출력한 바이트 수, 실패한 경우 -1
+long long block_encoding( const unsigned char *data, size_t size, FILE *outfp, size_t block_size, int max_len, int streams, int nthreads)
+{
+	unsigned char buf[BLOCK_FOOTER_SIZE];
+	size_t nblocks = (size + block_size - 1) / block_size;
+	int batch_size = nthreads * BATCH_PER_THREAD;
+	uint64_t *offsets;
+	long long written = 0;
+	tBatch batch;
+	size_t first, i;
+	int error = 0;
+	
+	batch.checksum = (streams & BLOCK_CHECKSUM) != 0;
+	streams &= ~BLOCK_CHECKSUM;
+	if (block_size < MIN_BLOCK_SIZE || block_size > MAX_BLOCK_SIZE) return -1;
+	if (streams != 1 && streams != NUM_STREAMS) return -1;
+	
+	offsets = (uint64_t *)malloc( sizeof(uint64_t) * (nblocks + 1));
+	batch.jobs = (tBlockJob *)malloc( sizeof(tBlockJob) * batch_size);
+	batch.max_len = max_len;
+	batch.streams = streams;
+	
+	// 파일 헤더
+	memcpy( buf, BLOCK_MAGIC, 2);
+	buf[2] = BLOCK_VERSION;
+	buf[3] = streams | (batch.checksum ? BLOCK_CHECKSUM : 0);
+	put_u32( buf + 4, block_size);
+	fwrite( buf, 1, BLOCK_HEADER_SIZE, outfp);
+	written += BLOCK_HEADER_SIZE;
+	
+	// 블록 : batch_size개씩 병렬로 인코딩하여 순서대로 출력
+	for (first = 0; first < nblocks; first += batch_size)
+	{
+		int count = nblocks - first < (size_t)batch_size ? (int)(nblocks - first) : batch_size;
+		
+		for (i = 0; i < (size_t)count; i++)
+		{
+			size_t begin = (first + i) * block_size;
+			
+			batch.jobs[i].in = data + begin;
+			batch.jobs[i].in_size = size - begin < block_size ? size - begin : block_size;
+			batch.jobs[i].out = NULL;
+			batch.jobs[i].error = 0;
+		}
+		
+		parallel_for( count, nthreads, encode_job, &batch);
+		
+		for (i = 0; i < (size_t)count; i++)
+		{
+			if (batch.jobs[i].error) error = 1;
+			else
+			{
+				offsets[first + i] = written;
+				fwrite( batch.jobs[i].out, 1, batch.jobs[i].out_size, outfp);
+				written += batch.jobs[i].out_size;
+			}
+			free( batch.jobs[i].out);
+		}
+		if (error) break;
+	}
+	
+	if (!error)
+	{
+		// 끝 표시
+		put_u32( buf, 0);
+		fwrite( buf, 1, 4, outfp);
+		written += 4;
+		
+		// 블록 인덱스
+		uint64_t index_offset = written;
+		for (i = 0; i < nblocks; i++)
+		{
+			put_u64( buf, offsets[i]);
+			fwrite( buf, 1, 8, outfp);
+		}
+		written += nblocks * 8;
+		
+		// 파일 끝
+		put_u64( buf, index_offset);
+		put_u32( buf + 8, nblocks);
+		memcpy( buf + 12, BLOCK_INDEX_MAGIC, 4);
+		fwrite( buf, 1, BLOCK_FOOTER_SIZE, outfp);
+		written += BLOCK_FOOTER_SIZE;
+		
+		if (ferror( outfp)) error = 1;
+	}
+	
+	free( batch.jobs);
+	free( offsets);
+	
+	return error ? -1 : written;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// 블록 형식 파일의 파일 헤더와 파일 끝을 확인하고 블록 인덱스의 위치를 구함
+// return value : 0 성공, -1 형식이 맞지 않는 경우
+static int check_block_file( const unsigned char *data, size_t size, uint64_t *index_offset, size_t *nblocks)
+{
+	const unsigned char *footer;
+	
+	if (size < BLOCK_HEADER_SIZE + 4 + BLOCK_FOOTER_SIZE
+		|| memcmp( data, BLOCK_MAGIC, 2) != 0 || data[2] != BLOCK_VERSION) return -1;
+	int streams = data[3] & ~BLOCK_CHECKSUM;
+	if (streams != 1 && streams != NUM_STREAMS) return -1; // 스트림 형식은 블록 인덱스가 없음
+	
+	footer = data + size - BLOCK_FOOTER_SIZE;
+	if (memcmp( footer + 12, BLOCK_INDEX_MAGIC, 4) != 0) return -1;
+	*index_offset = get_u64( footer);
+	*nblocks = get_u32( footer + 8);
+	if (*index_offset + *nblocks * 8 != size - BLOCK_FOOTER_SIZE) return -1;
+	return 0;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// 메모리(data)에 올린 블록 형식 파일의 원본 크기 (블록 인덱스로 찾은 블록 헤더의 크기 합)
+// return value : 원본 바이트 수, -1 형식이 맞지 않는 경우
+long long block_decoded_size( const unsigned char *data, size_t size)
+{
+	uint64_t index_offset;
+	size_t nblocks, i;
+	long long total = 0;
+	
+	if (check_block_file( data, size, &index_offset, &nblocks) < 0) return -1;
+	
+	for (i = 0; i < nblocks; i++)
+	{
+		uint64_t offset = get_u64( data + index_offset + i * 8);
+		
+		if (offset < BLOCK_HEADER_SIZE || offset + 8 > index_offset) return -1;
+		total += get_u32( data + offset);
+	}
+	return total;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// 메모리(data)에 올린 블록 형식 파일을 디코딩하여 출력 파일(out)에 저장
+// 블록 인덱스로 각 블록의 위치를 찾아 nthreads개의 스레드가 나누어 디코딩
+// 출력 파일이 매핑되어 있으면 각 블록을 제 위치에 직접 디코딩하고, 아니면 블록 순서대로 출력
+// return value : 0 성공, -1 형식이 맞지 않는 경우
+int block_decoding( const unsigned char *data, size_t size, tOutput *out, int max_len, int nthreads)
+{
+	uint64_t index_offset;
+	size_t block_size, nblocks, first, i;
+	int batch_size = nthreads * BATCH_PER_THREAD;
+	tBatch batch;
+	int error = 0;
+	
+	// 파일 헤더와 파일 끝
+	if (check_block_file( data, size, &index_offset, &nblocks) < 0) return -1;
+	block_size = get_u32( data + 4);
+	
+	batch.jobs = (tBlockJob *)malloc( sizeof(tBlockJob) * batch_size);
+	batch.max_len = max_len;
+	batch.streams = data[3] & ~BLOCK_CHECKSUM;
+	batch.checksum = (data[3] & BLOCK_CHECKSUM) != 0;
+	
+	// 블록 : batch_size개씩 병렬로 디코딩
+	for (first = 0; first < nblocks && !error; first += batch_size)
+	{
+		int count = nblocks - first < (size_t)batch_size ? (int)(nblocks - first) : batch_size;
+		
+		for (i = 0; i < (size_t)count; i++)
+		{
+			uint64_t offset = get_u64( data + index_offset + (first + i) * 8);
+			size_t begin = (first + i) * block_size;
+			
+			batch.jobs[i].out = NULL;
+			batch.jobs[i].error = 0;
+			if (out->data != NULL)
+			{
+				// 매핑한 출력 파일에서 블록의 위치
+				if (begin >= out->size) batch.jobs[i].error = 1;
+				else
+				{
+					batch.jobs[i].out = out->data + begin;
+					batch.jobs[i].out_size = out->size - begin < block_size ? out->size - begin : block_size;
+				}
+			}
+			if (batch.jobs[i].error || offset < BLOCK_HEADER_SIZE || offset + BLOCK_JOB_HEADER( &batch) > index_offset)
+			{
+				batch.jobs[i].in = data;
+				batch.jobs[i].in_size = 0;
+				batch.jobs[i].error = 1;
+				continue;
+			}
+			batch.jobs[i].in = data + offset;
+			batch.jobs[i].in_size = index_offset - offset;
+			if (get_u32( data + offset) > block_size) batch.jobs[i].error = 1;
+		}
+		
+		parallel_for( count, nthreads, decode_job, &batch);
+		
+		for (i = 0; i < (size_t)count; i++)
+		{
+			if (batch.jobs[i].error && !error) error = batch.jobs[i].error;
+			if (out->data != NULL) continue;
+			if (!error && write_output( out, batch.jobs[i].out, batch.jobs[i].out_size) < 0) error = 1;
+			free( batch.jobs[i].out);
+		}
+	}
+	
+	// 매핑한 출력 파일은 모든 블록이 채워짐
+	if (!error && out->data != NULL) out->pos = out->size;
+	
+	free( batch.jobs);
+	return error == 2 ? -2 : (error ? -1 : 0);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// 단조 증가하는 현재 시각 (밀리초)
+static long long now_ms( void)
+{
+	struct timespec ts;
+	
+	clock_gettime( CLOCK_MONOTONIC, &ts);
+	return ts.tv_sec * 1000LL + ts.tv_nsec / 1000000;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// 입력 파일 디스크립터(fd)에서 block_size 크기의 창을 채울 때마다 블록 하나를 인코딩하여 출력 (스트림 형식)
+// 창이 덜 찼어도 창의 첫 바이트가 들어온 뒤 latency_ms가 지나면 입력이 계속 들어오더라도 그때까지의 데이터를 블록으로 출력 (음수이면 기다림)
+// 블록마다 출력을 비우므로(fflush) 메모리와 지연 시간이 창 크기로 제한됨
+// num_bytes : 읽은 입력의 바이트 수를 저장
+// return value : 출력한 바이트 수, 실패한 경우 -1
+long long block_encoding_stream( int fd, FILE *outfp, size_t block_size, int max_len, int streams, int latency_ms, long long *num_bytes)
+{
+	unsigned char buf[BLOCK_HEADER_SIZE];
+	unsigned char *window;
+	struct pollfd pfd;
+	size_t fill = 0;
+	long long first_ms = 0; // 창의 첫 바이트가 들어온 시각
+	long long written = 0;
+	tBlockJob job;
+	tBatch batch;
+	int eof = 0, error = 0;
+	
+	*num_bytes = 0;
+	batch.checksum = (streams & BLOCK_CHECKSUM) != 0;
+	streams &= ~BLOCK_CHECKSUM;
+	if (block_size < MIN_BLOCK_SIZE || block_size > MAX_BLOCK_SIZE) return -1;
+	if (streams != 1 && streams != NUM_STREAMS) return -1;
+	
+	window = (unsigned char *)malloc( block_size);
+	if (window == NULL) return -1;
+	
+	batch.jobs = &job;
+	batch.max_len = max_len;
+	batch.streams = streams;
+	pfd.fd = fd;
+	pfd.events = POLLIN;
+	
+	// 파일 헤더
+	memcpy( buf, BLOCK_MAGIC, 2);
+	buf[2] = BLOCK_VERSION;
+	buf[3] = streams | BLOCK_STREAMED | (batch.checksum ? BLOCK_CHECKSUM : 0);
+	put_u32( buf + 4, block_size);
+	fwrite( buf, 1, BLOCK_HEADER_SIZE, outfp);
+	fflush( outfp);
+	written += BLOCK_HEADER_SIZE;
+	
+	while (!eof && !error)
+	{
+		// 창에 데이터가 있으면 창의 첫 바이트로부터 latency_ms가 될 때까지만 다음 입력을 기다림
+		int ready = 1;
+		
+		if (fill > 0 && latency_ms >= 0)
+		{
+			long long remain = first_ms + latency_ms - now_ms();
+			
+			ready = remain > 0 ? poll( &pfd, 1, remain) : 0;
+			if (ready < 0 && errno == EINTR) continue;
+		}
+		if (ready != 0)
+		{
+			ssize_t n = read( fd, window + fill, block_size - fill);
+			
+			if (n < 0)
+			{
+				if (errno == EINTR) continue;
+				error = 1;
+				break;
+			}
+			if (n == 0) eof = 1;
+			if (fill == 0 && n > 0) first_ms = now_ms();
+			fill += n;
+			if (fill < block_size && !eof) continue;
+		}
+		if (fill == 0) continue;
+		
+		// 창의 데이터를 블록 하나로 출력
+		job.in = window;
+		job.in_size = fill;
+		job.out = NULL;
+		job.error = 0;
+		encode_job( &batch, 0);
+		if (job.error) error = 1;
+		else
+		{
+			fwrite( job.out, 1, job.out_size, outfp);
+			if (fflush( outfp) != 0) error = 1;
+			written += job.out_size;
+			*num_bytes += fill;
+		}
+		free( job.out);
+		fill = 0;
+	}
+	
+	if (!error)
+	{
+		// 끝 표시
+		put_u32( buf, 0);
+		fwrite( buf, 1, 4, outfp);
+		if (fflush( outfp) != 0) error = 1;
+		written += 4;
+	}
+	
+	free( window);
+	return error ? -1 : written;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// 블록 형식 또는 스트림 형식 파일을 입력 파일(infp)에서 앞에서부터 차례로 읽어 디코딩하여 출력 파일(out)에 저장
+// header : 이미 읽은 파일 헤더 (BLOCK_HEADER_SIZE 바이트), 끝 표시까지 읽음 (블록 인덱스를 사용하지 않음)
+// 블록마다 출력을 비움
+// return value : 0 성공, -1 형식이 맞지 않거나 입력이 중간에 끝난 경우
+int block_decoding_stream( const unsigned char *header, FILE *infp, tOutput *out, int max_len)
+{
+	size_t block_size = get_u32( header + 4);
+	size_t bound = 12 + 1 + 256 + STREAMS_BOUND( block_size);
+	unsigned char *in, *decoded;
+	tBlockJob job;
+	tBatch batch;
+	int hdr, error = 0;
+	
+	if (memcmp( header, BLOCK_MAGIC, 2) != 0 || header[2] != BLOCK_VERSION) return -1;
+	batch.streams = header[3] & ~(BLOCK_STREAMED | BLOCK_CHECKSUM);
+	batch.checksum = (header[3] & BLOCK_CHECKSUM) != 0;
+	hdr = BLOCK_JOB_HEADER( &batch);
+	if (batch.streams != 1 && batch.streams != NUM_STREAMS) return -1;
+	if (block_size < MIN_BLOCK_SIZE || block_size > MAX_BLOCK_SIZE) return -1;
+	batch.jobs = &job;
+	batch.max_len = max_len;
+	
+	in = (unsigned char *)malloc( bound);
+	decoded = (unsigned char *)malloc( block_size);
+	if (in == NULL || decoded == NULL)
+	{
+		free( in);
+		free( decoded);
+		return -1;
+	}
+	
+	while (1)
+	{
+		size_t raw_size, nbytes, nlengths;
+		
+		// 원본 크기 (0이면 끝 표시)
+		if (fread( in, 1, 4, infp) != 4)
+		{
+			error = 1;
+			break;
+		}
+		raw_size = get_u32( in);
+		if (raw_size == 0) break;
+		
+		// 비트열 크기, CRC32C와 코드 길이의 형식 (길이당 비트 수)
+		if (raw_size > block_size || fread( in + 4, 1, hdr - 3, infp) != (size_t)hdr - 3 || (in[hdr] != 4 && in[hdr] != 8))
+		{
+			error = 1;
+			break;
+		}
+		nbytes = get_u32( in + 4);
+		if (batch.streams != NUM_STREAMS) nbytes = (nbytes + 7) / 8; // 비트 수
+		nlengths = in[hdr] == 4 ? 128 : 256;
+		if (hdr + 1 + nlengths + nbytes > bound || fread( in + hdr + 1, 1, nlengths + nbytes, infp) != nlengths + nbytes)
+		{
+			error = 1;
+			break;
+		}
+		
+		// 블록 하나를 디코딩하여 바로 출력
+		job.in = in;
+		job.in_size = hdr + 1 + nlengths + nbytes;
+		job.out = decoded;
+		job.out_size = raw_size;
+		job.error = 0;
+		decode_job( &batch, 0);
+		if (job.error || write_output( out, decoded, raw_size) < 0 || flush_output( out) < 0)
+		{
+			error = job.error ? job.error : 1;
+			break;
+		}
+	}
+	
+	free( in);
+	free( decoded);
+	return error == 2 ? -2 : (error ? -1 : 0);
+}
@@ -0,0 +1,72 @@
+#ifndef BLOCK_H
+#define BLOCK_H
+
+#include <stdio.h>
+#include <stdint.h>
+
+#include "huffman.h"
+
+////////////////////////////////////////////////////////////////////////////////
+// 블록 형식 : 입력을 일정한 크기의 블록으로 나누어 블록마다 따로 허프만 코드를 만듦
+// 블록끼리 독립적이므로 여러 스레드에서 동시에 인코딩/디코딩할 수 있음
+//
+// [파일 헤더]   "HB", 버전(1), 비트열 수(1), 블록 크기(4)
+// [블록] ...    원본 크기(4), 비트열 크기(4), [CRC32C(4)], 코드 길이(pack_code_lengths 형식), 비트열
+//               비트열 수가 1이면 비트열 크기는 비트 수,
+//               NUM_STREAMS이면 encoding_streams 형식이고 비트열 크기는 바이트 수
+//               CRC32C는 비트열 수에 BLOCK_CHECKSUM 비트를 표시한 경우에만 있음 (블록 원본의 체크섬)
+// [끝 표시]     원본 크기 0 (4)
+// [블록 인덱스] 블록별 파일 내 위치(8) ...
+// [파일 끝]     블록 인덱스의 위치(8), 블록 수(4), "HBIX"
+// 정수는 모두 little-endian
+//
+// 스트림 형식 : 비트열 수에 BLOCK_STREAMED 비트를 표시하고 [끝 표시]까지만 출력 (블록 인덱스 없음)
+// 크기를 모르는 입력(파이프)을 창(블록) 단위로 도착하는 대로 인코딩하고, 앞에서부터 차례로 디코딩
+
+#define BLOCK_MAGIC			"HB"
+#define BLOCK_INDEX_MAGIC	"HBIX"
+#define BLOCK_VERSION		1
+
+#define BLOCK_STREAMED		0x80	// 스트림 형식 표시 (파일 헤더의 비트열 수 바이트)
+#define BLOCK_CHECKSUM		0x40	// 블록마다 CRC32C 저장 (파일 헤더의 비트열 수 바이트)
+
+#define BLOCK_HEADER_SIZE	8		// 파일 헤더의 크기
+#define BLOCK_FOOTER_SIZE	16		// 파일 끝의 크기
+
+#define DEFAULT_BLOCK_SIZE	(1 << 20)
+#define MIN_BLOCK_SIZE		(1 << 12)
+#define MAX_BLOCK_SIZE		(1 << 28)	// 블록의 비트 수가 32비트로 표현되는 크기
+
+// 메모리(data)에 있는 텍스트를 block_size 크기의 블록으로 나누어 출력 파일(outfp)로 인코딩
+// max_len : 코드 길이 제한 (0이면 제한 없음)
+// streams : 블록마다의 비트열 수 (1 또는 NUM_STREAMS), BLOCK_CHECKSUM을 더하면 블록마다 원본의 CRC32C를 저장
+// nthreads개의 스레드가 블록을 나누어 인코딩하고, 출력은 블록 순서대로
+// return value : 출력한 바이트 수, 실패한 경우 -1
+long long block_encoding( const unsigned char *data, size_t size, FILE *outfp, size_t block_size, int max_len, int streams, int nthreads);
+
+// 메모리(data)에 올린 블록 형식 파일의 원본 크기 (블록 인덱스로 찾은 블록 헤더의 크기 합)
+// return value : 원본 바이트 수, -1 형식이 맞지 않는 경우
+long long block_decoded_size( const unsigned char *data, size_t size);
+
+// 메모리(data)에 올린 블록 형식 파일을 디코딩하여 출력 파일(out)에 저장
+// max_len : 허용하는 코드 길이의 최대값
+// nthreads개의 스레드가 블록을 나누어 디코딩
+// 출력 파일이 매핑되어 있으면 각 블록을 제 위치에 직접 디코딩하고, 아니면 블록 순서대로 출력
+// CRC32C가 있으면 블록마다 디코딩한 결과로 확인
+// return value : 0 성공, -1 형식이 맞지 않는 경우, -2 CRC32C가 맞지 않는 경우
+int block_decoding( const unsigned char *data, size_t size, tOutput *out, int max_len, int nthreads);
+
+// 입력 파일 디스크립터(fd)에서 block_size 크기의 창을 채울 때마다 블록 하나를 인코딩하여 출력 (스트림 형식)
+// 창이 덜 찼어도 창의 첫 바이트가 들어온 뒤 latency_ms가 지나면 입력이 계속 들어오더라도 그때까지의 데이터를 블록으로 출력 (음수이면 기다림)
+// 블록마다 출력을 비우므로(fflush) 메모리와 지연 시간이 창 크기로 제한됨
+// num_bytes : 읽은 입력의 바이트 수를 저장
+// return value : 출력한 바이트 수, 실패한 경우 -1
+long long block_encoding_stream( int fd, FILE *outfp, size_t block_size, int max_len, int streams, int latency_ms, long long *num_bytes);
+
+// 블록 형식 또는 스트림 형식 파일을 입력 파일(infp)에서 앞에서부터 차례로 읽어 디코딩하여 출력 파일(out)에 저장
+// header : 이미 읽은 파일 헤더 (BLOCK_HEADER_SIZE 바이트), 끝 표시까지 읽음 (블록 인덱스를 사용하지 않음)
+// 블록마다 출력을 비움, CRC32C가 있으면 블록마다 확인
+// return value : 0 성공, -1 형식이 맞지 않거나 입력이 중간에 끝난 경우, -2 CRC32C가 맞지 않는 경우
+int block_decoding_stream( const unsigned char *header, FILE *infp, tOutput *out, int max_len);
+
+#endif
@@ -0,0 +1,110 @@
+#include <stdio.h>
+#include <pthread.h>
+
+#include "crc32c.h"
+
+#if defined(__x86_64__) && defined(__GNUC__)
+#include <nmmintrin.h>
+#define HAVE_SSE42_PATH	1
+#endif
+
+#define CRC32C_POLY	0x82F63B78	// 비트 순서를 뒤집은 Castagnoli 다항식
+
+// slicing-by-8 테이블 : table[k][b]는 바이트 b 다음에 0 바이트 k개가 이어질 때의 CRC
+static uint32_t table[8][256];
+static pthread_once_t table_once = PTHREAD_ONCE_INIT;
+
+////////////////////////////////////////////////////////////////////////////////
+// 테이블 생성 (처음 호출할 때 한번만)
+static void make_table( void)
+{
+	uint32_t crc;
+	int i, j, k;
+	
+	for (i = 0; i < 256; i++)
+	{
+		crc = i;
+		for (j = 0; j < 8; j++) crc = (crc >> 1) ^ (CRC32C_POLY & -(crc & 1));
+		table[0][i] = crc;
+	}
+	for (i = 0; i < 256; i++)
+	{
+		for (k = 1; k < 8; k++) table[k][i] = (table[k - 1][i] >> 8) ^ table[0][table[k - 1][i] & 0xff];
+	}
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// 테이블(slicing-by-8)만 사용하여 계산한 CRC32C
+// 8바이트마다 테이블 8개를 한번씩 찾아서 XOR
+uint32_t crc32c_sw( uint32_t crc, const unsigned char *data, size_t size)
+{
+	pthread_once( &table_once, make_table);
+	crc = ~crc;
+	
+	// 8바이트 단위
+	while (size >= 8)
+	{
+		uint32_t lo = crc ^ (data[0] | (data[1] << 8) | (data[2] << 16) | ((uint32_t)data[3] << 24));
+		
+		crc = table[7][lo & 0xff] ^ table[6][(lo >> 8) & 0xff] ^ table[5][(lo >> 16) & 0xff] ^ table[4][lo >> 24]
+			^ table[3][data[4]] ^ table[2][data[5]] ^ table[1][data[6]] ^ table[0][data[7]];
+		data += 8;
+		size -= 8;
+	}
+	
+	// 남은 바이트
+	while (size-- > 0) crc = (crc >> 8) ^ table[0][(crc ^ *data++) & 0xff];
+	
+	return ~crc;
+}
+
+#ifdef HAVE_SSE42_PATH
+////////////////////////////////////////////////////////////////////////////////
+// crc32 명령어로 계산한 CRC32C (8바이트씩)
+__attribute__((target("sse4.2")))
+static uint32_t crc32c_sse42( uint32_t crc, const unsigned char *data, size_t size)
+{
+	uint64_t c = ~crc;
+	uint64_t v;
+	
+	// 8바이트 경계까지
+	while (size > 0 && ((uintptr_t)data & 7))
+	{
+		c = _mm_crc32_u8( c, *data++);
+		size--;
+	}
+	
+	while (size >= 8)
+	{
+		__builtin_memcpy( &v, data, 8);
+		c = _mm_crc32_u64( c, v);
+		data += 8;
+		size -= 8;
+	}
+	
+	while (size-- > 0) c = _mm_crc32_u8( c, *data++);
+	
+	return ~(uint32_t)c;
+}
+#endif
+
+////////////////////////////////////////////////////////////////////////////////
+// crc32c 함수가 crc32 명령어를 사용하는지
+int crc32c_hw( void)
+{
+#ifdef HAVE_SSE42_PATH
+	return __builtin_cpu_supports( "sse4.2") != 0;
+#else
+	return 0;
+#endif
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// 메모리(data)의 CRC32C (SSE4.2가 있으면 crc32 명령어, 없으면 slicing-by-8)
+uint32_t crc32c( uint32_t crc, const unsigned char *data, size_t size)
+{
+#ifdef HAVE_SSE42_PATH
+	if (__builtin_cpu_supports( "sse4.2")) return crc32c_sse42( crc, data, size);
+#endif
+	return crc32c_sw( crc, data, size);
+}
@@ -0,0 +1,22 @@
+#ifndef CRC32C_H
+#define CRC32C_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+////////////////////////////////////////////////////////////////////////////////
+// CRC32C (Castagnoli, 다항식 0x82F63B78) 체크섬
+// SSE4.2를 지원하는 CPU는 crc32 명령어를, 아니면 slicing-by-8 테이블을 사용
+// crc : 앞 부분의 CRC (처음에는 0), 나누어 계산한 결과를 이어서 계산할 수 있음
+
+// 메모리(data)의 CRC32C
+uint32_t crc32c( uint32_t crc, const unsigned char *data, size_t size);
+
+// 테이블(slicing-by-8)만 사용하여 계산한 CRC32C (성능 비교용)
+uint32_t crc32c_sw( uint32_t crc, const unsigned char *data, size_t size);
+
+// crc32c 함수가 crc32 명령어를 사용하는지
+// return value : 1 하드웨어, 0 소프트웨어
+int crc32c_hw( void);
+
+#endif
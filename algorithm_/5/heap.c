@@ -8,12 +8,12 @@
 void heapPrint( HEAP *heap)
 {
 	int i;
-	tNode **p = heap->heapArr;
+	tHeapItem *p = heap->heapArr;
 	int last = heap->last;
-	
+
 	for( i = 0; i <= last; i++)
 	{
-		printf("[%d]%c(%6d)\n", i, p[i]->data, p[i]->freq);
+		printf("[%d]%d(%6lld)\n", i, p[i].id, p[i].key);
 	}
 	printf( "\n");
 }
@@ -21,117 +21,232 @@ void heapPrint( HEAP *heap)
 ////////////////////////////////////////////////////////////////////////////////
 // 힙 생성
 // 배열을 위한 메모리 할당 (capacity)
+// arity : 자식 수 (2, 4, 8)
+// compare : 원소 비교 함수 (NULL이면 키가 작은 원소가 먼저)
 // last = -1
-HEAP *heapCreate( int capacity)
+// return value : 힙의 포인터, arity가 잘못되었거나 메모리가 부족한 경우 NULL
+HEAP *heapCreate( int capacity, int arity, HEAP_CMP compare, void *arg)
 {
 	HEAP *heap;
-	
+	int i;
+
+	if (arity != 2 && arity != 4 && arity != 8) return 0;
+
 	heap = (HEAP *)malloc( sizeof(HEAP));
 	if (!heap) return 0;
 
 	heap->last = -1;
 	heap->capacity = capacity;
-	heap->heapArr = (tNode **)malloc( sizeof(tNode *) * capacity);
-	if (heap->heapArr == 0)
+	heap->shift = arity == 2 ? 1 : (arity == 4 ? 2 : 3);
+	heap->compare = compare;
+	heap->arg = arg;
+	heap->heapArr = (tHeapItem *)malloc( sizeof(tHeapItem) * capacity);
+	heap->pos = (int *)malloc( sizeof(int) * capacity);
+	if (heap->heapArr == 0 || heap->pos == 0)
 	{
 		fprintf( stderr, "Error : not enough memory!\n");
+		free( heap->heapArr);
+		free( heap->pos);
 		free( heap);
 		return 0;
 	}
+	for (i = 0; i < capacity; i++) heap->pos[i] = -1;
+
 	return heap;
 }
 
+////////////////////////////////////////////////////////////////////////////////
+// a가 b보다 먼저 나와야 하는지 비교
+static inline int _before( HEAP *heap, const tHeapItem *a, const tHeapItem *b)
+{
+	if (heap->compare) return heap->compare( a, b, heap->arg) < 0;
+	return a->key < b->key;
+}
+
 ////////////////////////////////////////////////////////////////////////////////
 // 최소힙 유지
+// 옮길 원소를 빼두고 부모를 아래로 내린 뒤 마지막 자리에 한번만 저장
 static void _reheapUp( HEAP *heap, int index)
 {
-	tNode **arr = heap->heapArr;
+	tHeapItem *arr = heap->heapArr;
+	tHeapItem item = arr[index];
 	int parent;
-	
-	while(1)
+
+	while (index > 0)
+	{
+		parent = (index - 1) >> heap->shift;
+
+		if (!_before( heap, &item, &arr[parent])) break;
+
+		arr[index] = arr[parent];
+		heap->pos[arr[index].id] = index;
+		index = parent;
+	}
+	arr[index] = item;
+	heap->pos[item.id] = index;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// 최소힙 유지
+// 자식 중 가장 작은 원소와 비교하여 내려감
+static void _reheapDown( HEAP *heap, int index)
+{
+	tHeapItem *arr = heap->heapArr;
+	tHeapItem item = arr[index];
+	int last = heap->last;
+	int arity = 1 << heap->shift;
+	int first, end, small, i;
+
+	while (1)
 	{
-		if (index == 0) return; // root node
-		
-		parent = (index - 1) / 2;
-		
-		if (arr[index]->freq < arr[parent]->freq) // exchange (for minheap)
+		first = (index << heap->shift) + 1;
+		if (first > last) break; // leaf node
+
+		end = first + arity - 1;
+		if (end > last) end = last;
+
+		small = first; // index of the child with the smallest key
+		for (i = first + 1; i <= end; i++)
 		{
-			tNode *temp = arr[index];
-			arr[index] = arr[parent];
-			arr[parent] = temp;
-			
-			index = parent;
+			if (_before( heap, &arr[i], &arr[small])) small = i;
 		}
-		else return;
+
+		if (!_before( heap, &arr[small], &item)) break;
+
+		arr[index] = arr[small];
+		heap->pos[arr[index].id] = index;
+		index = small;
 	}
+	arr[index] = item;
+	heap->pos[item.id] = index;
 }
 
 ////////////////////////////////////////////////////////////////////////////////
 // 힙에 원소 삽입
 // _reheapUp 함수 호출
-int heapInsert( HEAP *heap, tNode *data)
+// return value : 1 성공, 0 힙이 가득 찼거나 원소 번호가 잘못되었거나 이미 힙에 있는 경우
+int heapInsert( HEAP *heap, long long key, int id)
 {
 	if (heap->last == heap->capacity - 1)
 		return 0;
-	
+	if (id < 0 || id >= heap->capacity || heap->pos[id] >= 0)
+		return 0;
+
 	(heap->last)++;
-	(heap->heapArr)[heap->last] = data;
-	
+	heap->heapArr[heap->last].key = key;
+	heap->heapArr[heap->last].id = id;
+
 	_reheapUp( heap, heap->last);
-	
+
 	return 1;
 }
 
 ////////////////////////////////////////////////////////////////////////////////
-// 최소힙 유지
-static void _reheapDown( HEAP *heap, int index)
+// 최소값 제거
+// _reheapDown 함수 호출
+// return value : 제거한 원소 번호, 빈 힙인 경우 -1
+int heapDelete( HEAP *heap, long long *key)
+{
+	if (heap->last == -1) return -1; // empty heap
+
+	tHeapItem item = heap->heapArr[0];
+	heap->pos[item.id] = -1;
+	if (key) *key = item.key;
+
+	heap->heapArr[0] = heap->heapArr[heap->last];
+	(heap->last)--;
+
+	if (heap->last >= 0) _reheapDown( heap, 0);
+
+	return item.id;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// 최소값 (제거하지 않음)
+// return value : 원소 번호, 빈 힙인 경우 -1
+int heapPeek( HEAP *heap, long long *key)
 {
-	tNode **arr = heap->heapArr;
-	tNode *leftData;
-	tNode *rightData;
-	int noright = 0;
-	int largeindex; // index of left or right child with large key
-	
-	while(1)
+	if (heap->last == -1) return -1; // empty heap
+
+	if (key) *key = heap->heapArr[0].key;
+	return heap->heapArr[0].id;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// 힙에 있는 원소(id)의 키를 key로 바꾸어 더 먼저 나오게 함 (비교 함수가 있으면 비교 함수로 판단)
+// _reheapUp 함수 호출
+// return value : 1 성공, 0 힙에 없는 원소이거나 바꾼 원소가 원래 원소보다 나중에 나와야 하는 경우
+int heapDecreaseKey( HEAP *heap, int id, long long key)
+{
+	tHeapItem item;
+	int index;
+
+	if (!heapContains( heap, id)) return 0;
+
+	index = heap->pos[id];
+	item = heap->heapArr[index];
+	item.key = key;
+	if (_before( heap, &heap->heapArr[index], &item)) return 0;
+
+	heap->heapArr[index] = item;
+	_reheapUp( heap, index);
+
+	return 1;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// 원소 번호(id)가 힙에 있는지 검사
+// return value : 1 힙에 있음, 0 없음
+int heapContains( HEAP *heap, int id)
+{
+	return id >= 0 && id < heap->capacity && heap->pos[id] >= 0;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// 힙에 저장된 원소 수
+int heapSize( HEAP *heap)
+{
+	return heap->last + 1;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// 배열(items)의 n개 원소로 힙을 한번에 구성 (bottom-up, O(n))
+// 마지막 내부 노드부터 root까지 차례로 _reheapDown
+// 힙에 있던 원소는 모두 버림
+// return value : 1 성공, 0 capacity보다 많거나 원소 번호가 잘못되었거나 중복된 경우
+int heapify( HEAP *heap, const tHeapItem items[], int n)
+{
+	int i;
+
+	if (n > heap->capacity) return 0;
+
+	for (i = 0; i <= heap->last; i++) heap->pos[heap->heapArr[i].id] = -1;
+	heap->last = -1;
+
+	for (i = 0; i < n; i++)
 	{
-		if ((index * 2 + 1) > heap->last) return; // leaf node (there is no left subtree)
-		
-		leftData = arr[index * 2 + 1];
-		if (index * 2 + 2 <= heap->last) rightData = arr[index * 2 + 2];
-		else noright = 1;
-		
-		if (noright || leftData->freq < rightData->freq) largeindex = index * 2 + 1; // left child
-		else largeindex = index * 2 + 2; // right child
-		
-		if (arr[index]->freq > arr[largeindex]->freq) // exchange (for minheap)
+		int id = items[i].id;
+
+		if (id < 0 || id >= heap->capacity || heap->pos[id] >= 0)
 		{
-			tNode *temp = arr[index];
-			arr[index] = arr[largeindex];
-			arr[largeindex] = temp;
-			
-			index = largeindex;
-			
-			noright = 0;
+			// 이미 넣은 원소를 되돌림
+			while (--i >= 0) heap->pos[items[i].id] = -1;
+			return 0;
 		}
-		else return;
+		heap->heapArr[i] = items[i];
+		heap->pos[id] = i;
 	}
-}
+	heap->last = n - 1;
 
-////////////////////////////////////////////////////////////////////////////////
-// 최소값 제거
-// _reheapDown 함수 호출
-tNode *heapDelete( HEAP *heap)
-{
-	if (heap->last == -1) return 0; // empty heap
-	
-	tNode *data = heap->heapArr[0];
-	heap->heapArr[0] = heap->heapArr[heap->last];
-	
-	(heap->last)--;
-	
-	_reheapDown( heap, 0);
-	
-	return data;
+	if (n > 1)
+	{
+		for (i = (n - 2) >> heap->shift; i >= 0; i--)
+		{
+			_reheapDown( heap, i);
+		}
+	}
+
+	return 1;
 }
 
 ////////////////////////////////////////////////////////////////////////////////
@@ -139,7 +254,6 @@ tNode *heapDelete( HEAP *heap)
 void heapDestroy( HEAP *heap)
 {
 	free(heap->heapArr);
+	free(heap->pos);
 	free(heap);
 }
-
-
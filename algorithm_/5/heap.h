@@ -1,26 +1,70 @@
 #ifndef HEAP_H
 #define HEAP_H
 
-#include "node.h"
-
 ////////////////////////////////////////////////////////////////////////////////
+// d-ary 최소힙 (우선순위 큐)
+// 원소는 키(key)와 원소 번호(id, 0 ~ capacity-1)의 쌍
+// 원소 번호별 힙 안의 위치를 저장하므로 decrease-key가 가능
+
+// 힙의 원소
+typedef struct
+{
+	long long	key;	// 우선순위 (작을수록 먼저 나옴)
+	int			id;		// 원소 번호 (0 ~ capacity-1)
+} tHeapItem;
+
+// 원소 비교 함수 (키 대신 사용)
+// arg : heapCreate 함수에 넘긴 값
+// return value : a가 b보다 먼저 나와야 하면 음수
+typedef int (*HEAP_CMP)( const tHeapItem *a, const tHeapItem *b, void *arg);
+
 typedef struct
 {
-	int	last;		// 힙에 저장된 마지막 element의 index (0부터 저장됨)
-	int	capacity;	// heapArr의 크기
-	tNode **heapArr;
+	int			last;		// 힙에 저장된 마지막 element의 index (0부터 저장됨)
+	int			capacity;	// heapArr의 크기 (원소 번호의 범위)
+	int			shift;		// log2(arity), 자식 index = (index << shift) + 1 ...
+	tHeapItem	*heapArr;
+	int			*pos;		// 원소 번호별 heapArr에서의 index (-1이면 힙에 없음)
+	HEAP_CMP	compare;	// 비교 함수 (NULL이면 키를 비교)
+	void		*arg;		// 비교 함수에 넘기는 값
 } HEAP;
 
 // 힙 생성
 // 배열을 위한 메모리 할당 (capacity)
+// arity : 자식 수 (2, 4, 8)
+// compare : 원소 비교 함수 (NULL이면 키가 작은 원소가 먼저)
 // last = -1
-HEAP *heapCreate( int capacity); 
+// return value : 힙의 포인터, arity가 잘못되었거나 메모리가 부족한 경우 NULL
+HEAP *heapCreate( int capacity, int arity, HEAP_CMP compare, void *arg);
 
 // 힙에 원소 삽입
-int heapInsert( HEAP *heap, tNode *data);
+// return value : 1 성공, 0 힙이 가득 찼거나 원소 번호가 잘못되었거나 이미 힙에 있는 경우
+int heapInsert( HEAP *heap, long long key, int id);
 
 // 최소값 제거
-tNode *heapDelete( HEAP *heap);
+// key가 NULL이 아니면 제거한 원소의 키를 저장
+// return value : 제거한 원소 번호, 빈 힙인 경우 -1
+int heapDelete( HEAP *heap, long long *key);
+
+// 최소값 (제거하지 않음)
+// return value : 원소 번호, 빈 힙인 경우 -1
+int heapPeek( HEAP *heap, long long *key);
+
+// 힙에 있는 원소(id)의 키를 key로 바꾸어 더 먼저 나오게 함 (비교 함수가 있으면 비교 함수로 판단)
+// return value : 1 성공, 0 힙에 없는 원소이거나 바꾼 원소가 원래 원소보다 나중에 나와야 하는 경우
+int heapDecreaseKey( HEAP *heap, int id, long long key);
+
+// 원소 번호(id)가 힙에 있는지 검사
+// return value : 1 힙에 있음, 0 없음
+int heapContains( HEAP *heap, int id);
+
+// 힙에 저장된 원소 수
+int heapSize( HEAP *heap);
+
+// 배열(items)의 n개 원소로 힙을 한번에 구성 (bottom-up, O(n))
+// 힙에 있던 원소는 모두 버림
+// return value : 1 성공, 0 capacity보다 많거나 원소 번호가 잘못되었거나 중복된 경우
+int heapify( HEAP *heap, const tHeapItem items[], int n);
 
 // 힙 메모리 해제
 void heapDestroy( HEAP *heap);
@@ -2,254 +2,2517 @@
 #include <stdlib.h>
 #include <assert.h>
 #include <string.h>
+#include <limits.h>
+#include <stdint.h>
+#include <math.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
 
 #include "node.h"
 #include "heap.h"
+#include "huffman.h"
+#include "parallel.h"
 
-// 허프만 트리를 순회하며 허프만 코드를 생성하여 codes에 저장
-// leaf 노드에서만 코드를 생성
-// strdup 함수 사용
-// make_huffman_code 함수에서 호출
-static void traverse_tree(tNode* root, char* code, int depth, char* codes[]);
+// 인코더의 입출력 버퍼 크기 (8의 배수)
+#define IO_BUF_SIZE	(1 << 16)
 
-// 새로운 노드를 생성
-// 좌/우 subtree가 NULL(0)이고 문자(data)와 빈도값(freq)이 저장됨
-// make_huffman_tree 함수에서 호출
-// return value : 노드의 포인터
-static tNode* newNode(unsigned char data, int freq);
+// 빈도 계산에서 부분 테이블(32비트)에 한번에 세는 최대 바이트 수
+#define COUNT_CHUNK	((size_t)1 << 32)
+
+// 비트 단위 출력 버퍼 (MSB부터 채움)
+typedef struct
+{
+	FILE			*fp;
+	unsigned char	*buf;	// 출력 버퍼
+	size_t			cap;	// buf의 크기 (8의 배수, 가득 차면 fp에 출력)
+	size_t			pos;	// buf에 저장된 바이트 수
+	uint64_t		acc;	// 출력할 비트 (상위 비트부터)
+	int				nacc;	// acc에 들어있는 비트 수
+	long long		nbytes;	// 파일에 출력한 바이트 수
+} tBitWriter;
+
+// 테이블 디코더가 한번에 살펴보는(peek) 비트 수
+// 이보다 긴 코드는 길이별 정규 코드 범위로 처리 (slow path)
+#define TABLE_BITS	11
+
+// 디코딩 테이블의 원소
+typedef struct
+{
+	unsigned char	data;	// 심볼
+	unsigned char	len;	// 코드 길이 (TABLE_BITS보다 긴 코드인 경우 0)
+} tEntry;
+
+// 정규 허프만 코드의 디코딩 테이블
+typedef struct
+{
+	tEntry			table[1 << TABLE_BITS];
+	int				max_len;					// 가장 긴 코드의 길이
+	uint64_t		first[MAX_CODE_LEN + 1];	// 길이별 첫번째 코드
+	int				count[MAX_CODE_LEN + 1];	// 길이별 심볼 수
+	int				index[MAX_CODE_LEN + 1];	// 길이별 첫번째 심볼의 sorted 배열 내 위치
+	unsigned char	sorted[256];				// (코드 길이, 심볼) 순으로 정렬된 심볼
+} tDecodeTable;
+
+// 비트 단위 입력 버퍼 (MSB부터 채움)
+typedef struct
+{
+	FILE			*fp;
+	unsigned char	buf[4096];
+	int				pos;
+	int				end;
+	uint64_t		acc;	// 읽어들인 비트 (상위 비트부터)
+	int				nacc;	// acc에 들어있는 비트 수
+} tBitReader;
+
+// 허프만 트리를 순회하며 문자별 코드 길이(leaf 노드의 깊이)를 lengths에 저장
+// 빈도가 0인 문자는 코드 길이 0 (코드 없음)
+// get_code_lengths 함수에서 호출
+static void traverse_tree(tTree* tree, int node, int depth, unsigned char lengths[]);
+
+// 노드 capacity개를 저장할 수 있는 빈 트리를 생성 (트리와 노드 풀을 한번에 할당)
+// 0번 노드는 NO_CHILD로 사용하므로 capacity는 1 + 노드 수 이상
+// return value : 트리의 포인터
+static tTree* newTree(int capacity);
+
+// 노드 풀에서 새로운 노드를 꺼냄
+// 좌/우 subtree가 NO_CHILD이고 문자(data)와 빈도값(freq)이 저장됨
+// make_huffman_tree, make_code_tree 함수에서 호출
+// return value : 노드의 번호
+static int newNode(tTree* tree, unsigned char data, long long freq);
 
 ////////////////////////////////////////////////////////////////////////////////
-// 허프만 코드를 화면에 출력
-void print_huffman_code( char *codes[])
+// 허프만 코드를 화면에 출력 ('0'/'1' 문자열)
+void print_huffman_code( tCode codes[])
 {
-	int i;
+	int i, j;
+	char code[MAX_CODE_LEN + 1];
 	
 	for (i = 0; i < 256; i++)
 	{
-		printf( "%d\t%s\n", i, codes[i]);
+		for (j = 0; j < codes[i].len; j++)
+			code[j] = ((codes[i].bits >> (codes[i].len - 1 - j)) & 1) ? '1' : '0';
+		code[j] = '\0';
+		printf( "%d\t%s\n", i, code);
 	}
 }
 
 ////////////////////////////////////////////////////////////////////////////////
-// 허프만 트리로부터 허프만 코드를 생성
-// traverse_tree 함수 호출
-void make_huffman_code( tNode *root, char *codes[])
+// 허프만 트리로부터 (정규) 허프만 코드를 생성
+// get_code_lengths, make_canonical_code 함수 호출
+// return value : 0 성공, -1 코드 길이가 잘못된 경우
+int make_huffman_code( tTree *tree, tCode codes[])
 {
-	char code[256];
+	unsigned char lengths[256];
 	
-	traverse_tree( root, code, 0, codes);
+	get_code_lengths( tree, lengths);
+	return make_canonical_code( lengths, codes);
 }
 
 /////////////////////////////////////////////////////////////////////////////////
 
-// 허프만 트리를 순회하며 허프만 코드를 생성하여 codes에 저장
-// leaf 노드에서만 코드를 생성
-// strdup 함수 사용
-// make_huffman_code 함수에서 호출
-static void traverse_tree(tNode* root, char* code, int depth, char* codes[])
+// 허프만 트리를 순회하며 문자별 코드 길이(leaf 노드의 깊이)를 lengths에 저장
+// 빈도가 0인 문자는 코드 길이 0 (코드 없음)
+// get_code_lengths 함수에서 호출
+static void traverse_tree(tTree* tree, int node, int depth, unsigned char lengths[])
 {
+	tNode* root = &tree->nodes[node];
+
 	if (root->right || root->left) {
 		if (root->left) {
-			code[depth] = '0';
-			traverse_tree(root->left, code, depth + 1, codes);
+			traverse_tree(tree, root->left, depth + 1, lengths);
 		}
 
 		if (root->right) {
-			code[depth] = '1';
-			traverse_tree(root->right, code, depth + 1, codes);
+			traverse_tree(tree, root->right, depth + 1, lengths);
 		}
 	}
 
 	else {
-		code[depth] = '\0';
-		codes[root->data] = strdup(code);
+		lengths[root->data] = root->freq ? depth : 0;
+	}
+
+}
+
+// 허프만 트리로부터 문자별 코드 길이를 구하여 lengths에 저장
+// 빈도가 0인 문자의 코드 길이는 0
+void get_code_lengths(tTree* tree, unsigned char lengths[]) {
+	memset(lengths, 0, 256);
+	traverse_tree(tree, tree->root, 0, lengths);
+}
+
+// 코드 길이 중 최대값
+int max_code_length(unsigned char lengths[]) {
+	int max_len = 0;
+
+	for (int i = 0; i < 256; i++) {
+		if (lengths[i] > max_len) max_len = lengths[i];
+	}
+	return max_len;
+}
+
+// 코드 길이(nsym개 심볼)로부터 길이별 첫번째 정규 코드를 구함
+// (짧은 코드가 먼저, 같은 길이에서는 문자 순서대로 연속된 값을 가짐)
+// return value : 가장 긴 코드의 길이, 코드 길이가 잘못된 경우 -1
+static int canonical_first(const unsigned char lengths[], int nsym, int count[], uint64_t first[]) {
+	int max_len = 0;
+	uint64_t code = 0;
+
+	memset(count, 0, sizeof(int) * (MAX_CODE_LEN + 1));
+	for (int i = 0; i < nsym; i++) {
+		if (lengths[i] > MAX_CODE_LEN) return -1;
+		count[lengths[i]]++;
+		if (lengths[i] > max_len) max_len = lengths[i];
+	}
+	count[0] = 0;
+
+	first[0] = 0;
+	for (int len = 1; len <= MAX_CODE_LEN; len++) {
+		code = (code + count[len - 1]) << 1;
+		first[len] = code;
+		// 코드 공간을 넘어가는 경우 (prefix 코드가 될 수 없음)
+		if (len < 64 && count[len] > 0 && code + count[len] > ((uint64_t)1 << len)) return -1;
+	}
+	return max_len;
+}
+
+// 코드 길이(nsym개 심볼)로부터 심볼별 정규 허프만 코드를 구하여 codes에 저장
+// 코드가 없는 심볼은 길이 0
+// return value : 0 성공, -1 코드 길이가 잘못된 경우
+static int canonical_codes(const unsigned char lengths[], int nsym, tCode codes[]) {
+	int count[MAX_CODE_LEN + 1];
+	uint64_t next[MAX_CODE_LEN + 1];
+
+	if (canonical_first(lengths, nsym, count, next) < 0) return -1;
+
+	for (int i = 0; i < nsym; i++) {
+		codes[i].bits = lengths[i] ? next[lengths[i]]++ : 0;
+		codes[i].len = lengths[i];
 	}
+	return 0;
+}
+
+// 코드 길이로부터 문자별 정규 허프만 코드(정수 코드 + 비트 길이)를 구하여 codes에 저장
+// 코드가 없는 문자는 길이 0
+// return value : 0 성공, -1 코드 길이가 잘못된 경우
+int make_canonical_code(unsigned char lengths[], tCode codes[]) {
+	return canonical_codes(lengths, 256, codes);
+}
+
+// 코드 길이로부터 디코딩용 허프만 트리를 생성
+// 정규 코드를 따라 leaf 노드를 배치 (힙을 사용하지 않음)
+// return value : 트리의 포인터, 코드 길이가 잘못된 경우 NULL
+tTree* make_code_tree(unsigned char lengths[]) {
+	tCode codes[256];
+	tTree* tree;
+	int capacity = 2;
+
+	if (make_canonical_code(lengths, codes) < 0) return 0;
+
+	// 노드 수는 코드 길이의 합 + root 이하
+	for (int i = 0; i < 256; i++) capacity += lengths[i];
+	tree = newTree(capacity);
+	tree->root = newNode(tree, 0, 0);
+
+	for (int i = 0; i < 256; i++) {
+		int cur = tree->root;
+		for (int j = lengths[i] - 1; j >= 0; j--) {
+			tNode* node = &tree->nodes[cur];
+			int next = ((codes[i].bits >> j) & 1) ? node->right : node->left;
+			if (next == NO_CHILD) {
+				next = newNode(tree, 0, 0);
+				if ((codes[i].bits >> j) & 1) tree->nodes[cur].right = next;
+				else tree->nodes[cur].left = next;
+			}
+			cur = next;
+		}
+		if (lengths[i]) tree->nodes[cur].data = i;
+	}
+	return tree;
+}
+
+// 코드 길이를 out에 저장
+// 길이당 비트 수(4 또는 8), 256개의 코드 길이 순서
+// 모든 길이가 15 이하이면 한 바이트에 두개씩(nibble) 저장
+// return value : 저장한 바이트 수 (129 또는 257)
+int pack_code_lengths(unsigned char lengths[], unsigned char* out) {
+	int width = 4;
+
+	for (int i = 0; i < 256; i++) {
+		if (lengths[i] > 15) width = 8;
+	}
+
+	out[0] = width;
+	if (width == 4) {
+		for (int i = 0; i < 128; i++) out[1 + i] = (lengths[2 * i] << 4) | lengths[2 * i + 1];
+		return 1 + 128;
+	}
+	memcpy(out + 1, lengths, 256);
+	return 1 + 256;
+}
+
+// in(size 바이트)에 저장된 코드 길이를 읽어서 lengths에 저장
+// return value : 읽은 바이트 수, 형식이 맞지 않는 경우 -1
+int unpack_code_lengths(const unsigned char* in, size_t size, unsigned char lengths[]) {
+	if (size < 1) return -1;
+
+	if (in[0] == 4) {
+		if (size < 1 + 128) return -1;
+		for (int i = 0; i < 128; i++) {
+			lengths[2 * i] = in[1 + i] >> 4;
+			lengths[2 * i + 1] = in[1 + i] & 0x0f;
+		}
+	}
+	else if (in[0] == 8) {
+		if (size < 1 + 256) return -1;
+		memcpy(lengths, in + 1, 256);
+	}
+	else return -1;
+
+	for (int i = 0; i < 256; i++) {
+		if (lengths[i] > MAX_CODE_LEN) return -1;
+	}
+	return in[0] == 4 ? 1 + 128 : 1 + 256;
+}
+
+// 코드 길이(헤더)를 파일에 저장
+// magic 다음에 pack_code_lengths 형식
+void write_code_lengths(FILE* fp, unsigned char lengths[]) {
+	unsigned char packed[1 + 256];
+	int n = pack_code_lengths(lengths, packed);
+
+	fwrite(HUF_MAGIC, 1, 2, fp);
+	fwrite(packed, 1, n, fp);
+}
+
+// 파일로부터 코드 길이(헤더)를 읽어서 lengths에 저장
+// 이전 형식(HUF_MAGIC_V1) 파일도 읽음
+// return value : 0 성공, -1 형식이 맞지 않는 경우
+int read_code_lengths(FILE* fp, unsigned char lengths[]) {
+	unsigned char magic[2];
+	unsigned char packed[1 + 256];
+	int n;
 
+	if (fread(magic, 1, 2, fp) != 2) return -1;
+	if (memcmp(magic, HUF_MAGIC, 2) != 0 && memcmp(magic, HUF_MAGIC_V1, 2) != 0) return -1;
+	packed[0] = fgetc(fp);
+	n = packed[0] == 4 ? 128 : 256;
+	if (fread(packed + 1, 1, n, fp) != (size_t)n) return -1;
+
+	return unpack_code_lengths(packed, 1 + n, lengths) < 0 ? -1 : 0;
+}
+
+// 노드 capacity개를 저장할 수 있는 빈 트리를 생성 (트리와 노드 풀을 한번에 할당)
+// 0번 노드는 NO_CHILD로 사용하므로 capacity는 1 + 노드 수 이상
+// return value : 트리의 포인터
+static tTree* newTree(int capacity) {
+	tTree* tree = malloc(sizeof(tTree) + sizeof(tNode) * capacity);
+	tree->nodes = (tNode*)(tree + 1);
+	tree->capacity = capacity;
+	tree->count = 1;
+	tree->root = NO_CHILD;
+	memset(&tree->nodes[0], 0, sizeof(tNode));
+	return tree;
 }
 
-// 새로운 노드를 생성
-// 좌/우 subtree가 NULL(0)이고 문자(data)와 빈도값(freq)이 저장됨
-// make_huffman_tree 함수에서 호출
-// return value : 노드의 포인터
-static tNode* newNode(unsigned char data, int freq) {
-	tNode* t = malloc(sizeof(tNode));
+// 노드 풀에서 새로운 노드를 꺼냄
+// 좌/우 subtree가 NO_CHILD이고 문자(data)와 빈도값(freq)이 저장됨
+// make_huffman_tree, make_code_tree 함수에서 호출
+// return value : 노드의 번호
+static int newNode(tTree* tree, unsigned char data, long long freq) {
+	assert(tree->count < tree->capacity);
+	tNode* t = &tree->nodes[tree->count];
 	t->data = data;
 	t->freq = freq;
-	t->left = 0;
-	t->right = 0;
-	return t;
+	t->left = NO_CHILD;
+	t->right = NO_CHILD;
+	return tree->count++;
 }
 
 // 파일에 속한 각 문자(바이트)의 빈도 저장
 // return value : 파일에서 읽은 바이트 수
-int read_chars(FILE* fp, int ch_freq[]) {
-	int ch, bt = 0;
+long long read_chars(FILE* fp, long long ch_freq[]) {
+	unsigned char buf[IO_BUF_SIZE];
+	size_t n;
+	long long bt = 0;
+
+	while ((n = fread(buf, 1, sizeof(buf), fp)) > 0) {
+		count_chars(buf, n, ch_freq);
+		bt += n;
+	}
+
+	return bt;
+}
+
+// 메모리(data)에 있는 각 문자(바이트)의 빈도를 ch_freq에 더함
+// 같은 바이트가 반복될 때 같은 카운터를 연속으로 증가시키지 않도록(store-to-load 지연)
+// 4개의 부분 테이블에 번갈아 세고 마지막에 합침
+// 부분 테이블(32비트)이 넘치지 않도록 COUNT_CHUNK 바이트마다 ch_freq에 더함
+void count_chars(const unsigned char* data, size_t size, long long ch_freq[]) {
+	unsigned int t[4][256];
+	size_t i = 0;
 
-	do{
-		ch = fgetc(fp);
-		ch_freq[ch]++;
-		bt++;
-	} while(ch != EOF); 
+	while (size > COUNT_CHUNK) {
+		count_chars(data, COUNT_CHUNK, ch_freq);
+		data += COUNT_CHUNK;
+		size -= COUNT_CHUNK;
+	}
+
+	memset(t, 0, sizeof(t));
+	for (; i + 8 <= size; i += 8) {
+		uint64_t v;
+		memcpy(&v, data + i, 8);
+		t[0][v & 0xff]++;
+		t[1][(v >> 8) & 0xff]++;
+		t[2][(v >> 16) & 0xff]++;
+		t[3][(v >> 24) & 0xff]++;
+		t[0][(v >> 32) & 0xff]++;
+		t[1][(v >> 40) & 0xff]++;
+		t[2][(v >> 48) & 0xff]++;
+		t[3][v >> 56]++;
+	}
+	for (; i < size; i++) t[0][data[i]]++;
 
-	return bt - 1;
+	for (int c = 0; c < 256; c++) {
+		ch_freq[c] += (long long)t[0][c] + t[1][c] + t[2][c] + t[3][c];
+	}
 }
 
-// 파일로부터 문자별 빈도(256개)를 읽어서 ch_freq에 저장
-void get_char_freq(FILE* fp, int ch_freq[]) {
-	for (int i = 0; i < 256; i++)   fread(ch_freq+i, sizeof(int), 1, fp);
+// count_chars_parallel 함수에서 스레드별로 처리하는 구간과 결과
+typedef struct
+{
+	const unsigned char	*data;
+	size_t				size;
+	int					nchunks;
+	long long			(*freq)[256];	// 구간별 빈도
+} tHistJob;
+
+// index번째 구간의 빈도를 셈 (parallel_for에서 호출)
+static void count_chunk(void* arg, int index) {
+	tHistJob* job = arg;
+	size_t chunk = (job->size + job->nchunks - 1) / job->nchunks;
+	size_t begin = chunk * index;
+	size_t end = begin + chunk < job->size ? begin + chunk : job->size;
+
+	memset(job->freq[index], 0, sizeof(job->freq[index]));
+	if (begin < end) count_chars(job->data + begin, end - begin, job->freq[index]);
 }
 
-// 허프만 코드에 대한 메모리 해제
-void free_huffman_code(char* codes[]) {
-	for (int i = 0; i < 256; i++) {
-		free(codes[i]);
+// 메모리(data)를 nthreads개의 구간으로 나누어 스레드별로 빈도를 세고 ch_freq에 더함
+// 각 스레드는 자신의 테이블만 갱신하므로 스레드간 충돌이 없음
+void count_chars_parallel(const unsigned char* data, size_t size, long long ch_freq[], int nthreads) {
+	tHistJob job;
+
+	// 작은 입력은 스레드 생성 비용이 더 큼
+	if (nthreads <= 1 || size < (1 << 20)) {
+		count_chars(data, size, ch_freq);
+		return;
+	}
+
+	job.data = data;
+	job.size = size;
+	job.nchunks = nthreads;
+	job.freq = malloc(sizeof(*job.freq) * nthreads);
+
+	parallel_for(nthreads, nthreads, count_chunk, &job);
+
+	for (int t = 0; t < nthreads; t++) {
+		for (int c = 0; c < 256; c++) ch_freq[c] += job.freq[t][c];
 	}
+	free(job.freq);
 }
 
-// 허프만 트리를 생성
-// 1. capacity 256 짜리 빈(empty) 힙 생성 // HEAP *heap = heapCreate( 256);
-// 2. 개별 알파벳에 대한 노드 생성
-// 3. 힙에 삽입 (minheap 구성) // heapInsert( heap, node);
-// 4. 2개의 최소값을 갖는 트리 추출 // tNode *left = heapDelete( heap); tNode *right = heapDelete( heap);
-// 5. 두 트리를 결합 후 새 노드에 추가
-// 6. 새 트리를 힙에 삽입
-// 7. 힙에 한개의 노드가 남을 때까지 반복
-// return value: 트리의 root 노드의 포인터
-tNode* make_huffman_tree(int ch_freq[]) {
-	HEAP* huffman = heapCreate(256);
-	
-	tNode* nn;
-	tNode* Node;
-	for (int i = 0; i < 256; i++) {
-		Node=newNode(i, ch_freq[i]);
-		heapInsert(huffman,Node);
+// 입력 파일 전체를 메모리에 올림
+// 일반 파일은 메모리 매핑(mmap), 파이프 등은 버퍼에 모두 읽어들임
+// path가 "-"이면 표준 입력
+// return value : 0 성공, -1 실패
+int open_input(const char* path, tInput* in) {
+	struct stat st;
+	int fd = strcmp(path, "-") == 0 ? 0 : open(path, O_RDONLY);
+
+	in->data = 0;
+	in->size = 0;
+	in->mapped = 0;
+	if (fd < 0) return -1;
+
+	if (fstat(fd, &st) == 0 && S_ISREG(st.st_mode)) {
+		in->size = st.st_size;
+		if (in->size > 0) {
+			void* p = mmap(0, in->size, PROT_READ, MAP_PRIVATE, fd, 0);
+			if (p != MAP_FAILED) {
+				madvise(p, in->size, MADV_SEQUENTIAL);
+				in->data = p;
+				in->mapped = 1;
+				if (fd != 0) close(fd);
+				return 0;
+			}
+		}
+		else {
+			if (fd != 0) close(fd);
+			return 0;
+		}
+	}
+
+	// 메모리 매핑을 할 수 없는 입력 : 버퍼 크기를 늘려가며 읽음
+	size_t capacity = IO_BUF_SIZE;
+	ssize_t n = 0;
+	in->size = 0;
+	in->data = malloc(capacity);
+	while (in->data && (n = read(fd, in->data + in->size, capacity - in->size)) > 0) {
+		in->size += n;
+		if (in->size == capacity) {
+			capacity *= 2;
+			unsigned char* p = realloc(in->data, capacity);
+			if (p == 0) break;
+			in->data = p;
+		}
 	}
-	while (huffman->last != 0) {
-		tNode* ll = heapDelete(huffman);
-		tNode* rr = heapDelete(huffman);
-		nn = newNode(-1, ll->freq + rr->freq);
-		nn->left = ll;
-		nn->right = rr;
-		heapInsert(huffman, nn);
+	if (fd != 0) close(fd);
+	if (in->data == 0 || n < 0 || in->size == capacity) {
+		free(in->data);
+		in->data = 0;
+		return -1;
 	}
+	return 0;
+}
+
+// open_input 함수로 올린 입력을 해제
+void close_input(tInput* in) {
+	if (in->mapped) munmap(in->data, in->size);
+	else free(in->data);
+	in->data = 0;
+	in->size = 0;
+}
+
+// 디코딩 결과를 쓸 출력 파일을 엶
+// 크기(size)를 아는 일반 파일은 그 크기로 만들어 메모리 매핑 (out->data에 직접 씀)
+// path가 "-"이거나 크기를 모르는 경우(size < 0) 버퍼에 모아서 큰 단위로 출력
+// return value : 0 성공, -1 실패
+int open_output(const char* path, long long size, tOutput* out) {
+	int to_stdout = strcmp(path, "-") == 0;
 
-	heapDestroy(huffman);
-	return nn;
+	out->fp = 0;
+	out->data = 0;
+	out->size = 0;
+	out->pos = 0;
+	out->buf = 0;
+	out->nbuf = 0;
+
+	if (!to_stdout && size > 0) {
+		int fd = open(path, O_RDWR | O_CREAT | O_TRUNC, 0666);
+		if (fd < 0) return -1;
+		if (ftruncate(fd, size) == 0) {
+			void* p = mmap(0, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+			if (p != MAP_FAILED) {
+				close(fd);
+				out->data = p;
+				out->size = size;
+				return 0;
+			}
+		}
+		// 매핑할 수 없는 파일 : 버퍼 출력으로
+		close(fd);
+	}
 
+	out->fp = to_stdout ? stdout : fopen(path, "wb");
+	out->buf = malloc(IO_BUF_SIZE);
+	if (out->fp == 0 || out->buf == 0) {
+		if (out->fp && !to_stdout) fclose(out->fp);
+		free(out->buf);
+		out->fp = 0;
+		out->buf = 0;
+		return -1;
+	}
+	return 0;
 }
 
-// 허프만 트리 메모리 해제
-void destroyTree(tNode* root) {
-	if (root->left || root->right) {
-		if (root->left) {
-			destroyTree(root->left);
+// 출력 파일에 n 바이트를 씀
+// return value : 0 성공, -1 실패
+int write_output(tOutput* out, const unsigned char* p, size_t n) {
+	if (out->data) {
+		if (n > out->size - out->pos) return -1;
+		memcpy(out->data + out->pos, p, n);
+		out->pos += n;
+		return 0;
+	}
+
+	// 버퍼가 넘치면 버퍼를 먼저 출력하고, 큰 출력은 바로 씀
+	if (out->nbuf + n > IO_BUF_SIZE) {
+		if (out->nbuf && fwrite(out->buf, 1, out->nbuf, out->fp) != out->nbuf) return -1;
+		out->nbuf = 0;
+	}
+	if (n >= IO_BUF_SIZE) {
+		if (fwrite(p, 1, n, out->fp) != n) return -1;
+	}
+	else {
+		memcpy(out->buf + out->nbuf, p, n);
+		out->nbuf += n;
+	}
+	out->pos += n;
+	return 0;
+}
+
+// 버퍼에 모은 출력을 파일로 내보냄 (스트림 출력에서 블록마다 호출)
+// return value : 0 성공, -1 실패
+int flush_output(tOutput* out) {
+	if (out->data) return 0;
+
+	if (out->nbuf && fwrite(out->buf, 1, out->nbuf, out->fp) != out->nbuf) return -1;
+	out->nbuf = 0;
+	return fflush(out->fp) == 0 ? 0 : -1;
+}
+
+// 남은 버퍼를 출력하고 출력 파일을 닫음
+// return value : 0 성공, -1 쓰기에 실패했거나 매핑한 크기만큼 쓰지 않은 경우
+int close_output(tOutput* out) {
+	int ret = 0;
+
+	if (out->data) {
+		if (out->pos != out->size) ret = -1;
+		munmap(out->data, out->size);
+	}
+	else if (out->fp) {
+		if (out->nbuf && fwrite(out->buf, 1, out->nbuf, out->fp) != out->nbuf) ret = -1;
+		if (out->fp == stdout) {
+			if (fflush(out->fp) != 0) ret = -1;
 		}
-		if (root->right) {
-			destroyTree(root->right);
+		else if (fclose(out->fp) != 0) ret = -1;
+		free(out->buf);
+	}
+	out->fp = 0;
+	out->data = 0;
+	out->buf = 0;
+	return ret;
+}
+
+// 허프만 트리를 생성 (두 개의 큐를 이용하는 O(n) 방법)
+// 1. 빈도가 0이 아닌 문자만 leaf 노드로 만들어 빈도 순으로 정렬 (leaf 큐, 4-ary 힙으로 정렬)
+// 2. leaf 큐와 내부 노드 큐의 앞에서 빈도가 가장 작은 노드 2개를 꺼냄 (같으면 leaf 먼저)
+// 3. 두 트리를 결합한 새 노드를 내부 노드 큐의 뒤에 추가 (빈도가 증가하는 순서로 만들어짐)
+// 4. 노드가 한개 남을 때까지 반복
+// 문자가 하나뿐이면 빈도 0인 leaf를 더하여 코드 길이 1, 빈 파일이면 root만 있는 트리
+// 노드는 트리의 노드 풀(1 + 511개)에서 꺼냄
+// return value: 트리의 포인터
+tTree* make_huffman_tree(long long ch_freq[]) {
+	tTree* tree = newTree(1 + 2 * 256 - 1);
+	int leaves[256];	// leaf 큐 (빈도 순으로 정렬된 노드 번호)
+	int merged[255];	// 내부 노드 큐
+	int n = 0, head1 = 0, head2 = 0, tail2 = 0;
+
+	// 빈도 순으로 정렬된 leaf
+	// 빈도와 문자를 묶은 키로 힙을 한번에 구성(heapify)하고 차례로 꺼냄
+	tHeapItem items[256];
+	for (int i = 0; i < 256; i++) {
+		if (ch_freq[i] == 0) continue;
+		items[n].key = (ch_freq[i] << 8) | i;
+		items[n].id = i;
+		n++;
+	}
+	HEAP* heap = heapCreate(256, 4, 0, 0);
+	heapify(heap, items, n);
+	for (int i = 0; i < n; i++) {
+		int data = heapDelete(heap, 0);
+		leaves[i] = newNode(tree, data, ch_freq[data]);
+	}
+	heapDestroy(heap);
+
+	if (n == 0) {
+		tree->root = newNode(tree, 0, 0);
+		return tree;
+	}
+	if (n == 1) {
+		// 코드 길이가 1이 되도록 빈도 0인 다른 문자를 형제로 둠
+		unsigned char data = tree->nodes[leaves[0]].data;
+		leaves[1] = leaves[0];
+		leaves[0] = newNode(tree, data == 0 ? 1 : 0, 0);
+		n = 2;
+	}
+
+	while (n - head1 + tail2 - head2 > 1) {
+		int pick[2];
+
+		for (int k = 0; k < 2; k++) {
+			if (head2 == tail2 || (head1 < n && tree->nodes[leaves[head1]].freq <= tree->nodes[merged[head2]].freq))
+				pick[k] = leaves[head1++];
+			else
+				pick[k] = merged[head2++];
 		}
-		free(root);
+
+		int nn = newNode(tree, 0, tree->nodes[pick[0]].freq + tree->nodes[pick[1]].freq);
+		tree->nodes[nn].left = pick[0];
+		tree->nodes[nn].right = pick[1];
+		merged[tail2++] = nn;
 	}
-	else
-		free(root);
+	tree->root = merged[head2];
+
+	return tree;
 }
 
-// 입력 텍스트 파일(infp)을 허프만 코드를 이용하여 출력 파일(outfp)로 인코딩
-// return value : 인코딩된 텍스트의 바이트 수 (파일 크기와는 다름)
-int encoding(char* codes[], int ch_freq[], FILE* infp, FILE* outfp) {
+// package-merge 알고리즘에서 사용하는 리스트의 원소
+// leaf(문자) 또는 이전 단계 리스트의 연속된 두 원소를 묶은 package
+typedef struct
+{
+	uint64_t	weight;	// 빈도의 합
+	int			sym;	// leaf인 경우 문자, package인 경우 -1
+	int			child;	// package인 경우 이전 단계 리스트에서 첫번째 원소의 위치
+} tPMItem;
+
+// package-merge 결과에서 item에 포함된 leaf들의 코드 길이를 1씩 증가
+static void pm_count(tPMItem* lists[], int level, int index, unsigned char lengths[]) {
+	tPMItem* item = &lists[level][index];
+
+	if (item->sym >= 0) lengths[item->sym]++;
+	else {
+		pm_count(lists, level - 1, item->child, lengths);
+		pm_count(lists, level - 1, item->child + 1, lengths);
+	}
+}
 
-	for (int i = 0; i < 256; i++) fwrite(ch_freq+ i, sizeof(int), 1, outfp);
+// 코드 길이가 max_len 이하인 최적의 허프만 코드 길이를 구하여 lengths에 저장 (package-merge)
+// 빈도가 0인 문자의 코드 길이는 0
+// return value : 0 성공, -1 max_len이 너무 작은 경우 (문자 수 > 2^max_len)
+int get_limited_code_lengths(long long ch_freq[], int max_len, unsigned char lengths[]) {
+	tPMItem leaves[256];
+	tPMItem* lists[MAX_CODE_LEN + 1];
+	int size[MAX_CODE_LEN + 1];
+	int n = 0;
 
-	int nbits = 0;
-	int nbytes = 0;
-	int number = 0;
-	char buffer;
-	char* s;
-	int ch;
+	memset(lengths, 0, 256);
+	if (max_len < 1 || max_len > MAX_CODE_LEN) return -1;
 
+	// 빈도 순으로 정렬된 leaf (삽입 정렬)
 	for (int i = 0; i < 256; i++) {
-		number += strlen(codes[i]) * ch_freq[i];
+		if (ch_freq[i] == 0) continue;
+		int j = n++;
+		while (j > 0 && leaves[j - 1].weight > (uint64_t)ch_freq[i]) {
+			leaves[j] = leaves[j - 1];
+			j--;
+		}
+		leaves[j].weight = ch_freq[i];
+		leaves[j].sym = i;
+		leaves[j].child = -1;
 	}
 
-	while (1) {
-		ch = fgetc(infp);
-		if (ch == EOF) break;
-		for (s = codes[ch]; *s; s++) {
-			buffer = buffer << 1;
-			if (*s == '1') {
-				buffer = buffer | 1;
-			}
-			nbits++;
-			if (nbits == 8) {
-				fwrite(&buffer, sizeof(char), 1, outfp);
-				buffer = 0;
-				nbits = 0;
-				nbytes++;
+	if (n == 0) return 0;
+	if (n == 1) {
+		lengths[leaves[0].sym] = 1;
+		return 0;
+	}
+	if (max_len < 31 && n > (1 << max_len)) return -1;
+
+	// 1단계 리스트는 leaf만, 이후 단계는 leaf와 이전 단계의 package를 병합
+	lists[1] = malloc(sizeof(tPMItem) * n);
+	memcpy(lists[1], leaves, sizeof(tPMItem) * n);
+	size[1] = n;
+	for (int level = 2; level <= max_len; level++) {
+		int npkg = size[level - 1] / 2;
+		int i = 0, k = 0;
+
+		lists[level] = malloc(sizeof(tPMItem) * (n + npkg));
+		size[level] = 0;
+		while (i < n || k < npkg) {
+			uint64_t pw = k < npkg ? lists[level - 1][2 * k].weight + lists[level - 1][2 * k + 1].weight : 0;
+			tPMItem* dst = &lists[level][size[level]++];
+
+			if (k >= npkg || (i < n && leaves[i].weight <= pw)) *dst = leaves[i++];
+			else {
+				dst->weight = pw;
+				dst->sym = -1;
+				dst->child = 2 * k;
+				k++;
 			}
 		}
 	}
 
-		while (nbits) {
-			buffer = buffer << 1;
-			nbits++;
+	// 마지막 리스트의 앞쪽 2n-2개 원소에 포함된 횟수가 코드 길이
+	for (int i = 0; i < 2 * n - 2; i++) pm_count(lists, max_len, i, lengths);
 
-			if (nbits = 8) {
-				fwrite(&buffer, sizeof(char), 1, outfp);
-				nbytes++;
-				nbits = 0;
-				buffer = 0;
-			}
+	for (int level = 1; level <= max_len; level++) free(lists[level]);
+	return 0;
+}
+
+// 허프만 트리 메모리 해제 (노드 풀과 함께 한번에 해제)
+void destroyTree(tTree* tree) {
+	free(tree);
+}
 
+// 허프만 트리로부터 디코딩 전용 트리를 생성 (너비 우선 순서로 번호를 다시 매김)
+// 내부 노드를 큐에 넣은 순서가 새 번호
+// return value : 트리의 포인터, 내부 노드가 너무 많은 경우 NULL
+tFlatTree* make_flat_tree(tTree* tree) {
+	tFlatTree* flat = malloc(sizeof(tFlatTree));
+	int* queue = malloc(sizeof(int) * tree->count);	// 너비 우선 순서의 내부 노드 (원래 번호)
+	int head = 0, tail = 0;
+
+	flat->child = malloc(sizeof(uint16_t[2]) * (tree->count > 0 ? tree->count : 1));
+	flat->count = 0;
+
+	tNode* root = &tree->nodes[tree->root];
+	if (tree->root != NO_CHILD && (root->left || root->right)) queue[tail++] = tree->root;
+
+	while (head < tail) {
+		tNode* node = &tree->nodes[queue[head]];
+		int children[2] = { node->left, node->right };
+
+		for (int k = 0; k < 2; k++) {
+			tNode* child = &tree->nodes[children[k]];
+			if (children[k] == NO_CHILD) {
+				flat->child[head][k] = 0;
+			}
+			else if (child->left == NO_CHILD && child->right == NO_CHILD) {
+				flat->child[head][k] = FLAT_LEAF | child->data;
+			}
+			else {
+				if (tail >= FLAT_LEAF) {
+					free(queue);
+					destroy_flat_tree(flat);
+					return 0;
+				}
+				flat->child[head][k] = tail;
+				queue[tail++] = children[k];
+			}
 		}
+		head++;
+	}
+	flat->count = tail;
 
-		fwrite(&number, sizeof(int), 1, outfp);
-		return nbytes;
+	free(queue);
+	return flat;
 }
 
-// 입력 파일(infp)을 허프만 트리를 이용하여 텍스트 파일(outfp)로 디코딩
-void decoding(tNode* root, FILE* infp, FILE* outfp) {
-	
-	int nbits = 0;
-	tNode* cur =root;
+// 디코딩 전용 트리 메모리 해제
+void destroy_flat_tree(tFlatTree* flat) {
+	free(flat->child);
+	free(flat);
+}
 
-	fseek(infp, -sizeof(int), SEEK_END);
-	fread(&nbits, sizeof(int), 1, infp);
+// 64비트 값을 상위 바이트부터 (big-endian) p에 저장
+static void store_be64(unsigned char* p, uint64_t v) {
+#if defined(__GNUC__) && __BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__
+	v = __builtin_bswap64(v);
+	memcpy(p, &v, 8);
+#else
+	for (int i = 0; i < 8; i++) p[i] = v >> (56 - 8 * i);
+#endif
+}
 
-	fseek(infp, 256 * sizeof(int), SEEK_SET);
-	char strstr[100];
+// 비트열에 코드를 이어붙임
+// 코드를 64비트 누산기(acc)에 이어붙이고 가득 차면 8바이트 단위로 출력 버퍼에 저장
+static void put_codes(tBitWriter* bw, const tCode codes[], const unsigned char* data, size_t size) {
+	uint64_t acc = bw->acc;
+	int nacc = bw->nacc;
+	size_t pos = bw->pos;
 
-	while (1) {
+	for (size_t i = 0; i < size; i++) {
+		tCode c = codes[data[i]];
+		int room = 64 - nacc;
 
-		int end = fread(strstr, 1, 100, infp);
-		if (end == 0) {
-			break;
+		if (c.len < room) {
+			acc |= c.bits << (room - c.len);
+			nacc += c.len;
 		}
 		else {
+			// acc를 가득 채워 출력하고 남은 비트로 새로 시작
+			acc |= c.bits >> (c.len - room);
+			store_be64(bw->buf + pos, acc);
+			pos += 8;
+			nacc = c.len - room;
+			acc = nacc ? c.bits << (64 - nacc) : 0;
 
-			for (int i = 0; i < end; i++) {
-				for (int j = 0; j < 8; j++) {
-					if ((char)(strstr[i] & 0x80) == 0) {
+			if (pos == bw->cap) {
+				fwrite(bw->buf, 1, pos, bw->fp);
+				bw->nbytes += pos;
+				pos = 0;
+			}
+		}
+	}
 
-						cur = cur->left;
-					}
+	bw->acc = acc;
+	bw->nacc = nacc;
+	bw->pos = pos;
+}
 
-					else
-						cur = cur->right;
+// 코드 길이 헤더를 출력하고 비트열 출력을 시작
+static void begin_encoding(tBitWriter* bw, tCode codes[], FILE* outfp) {
+	unsigned char lengths[256];
 
-					strstr[i] = strstr[i] << 1;
-					nbits--;
+	for (int i = 0; i < 256; i++) lengths[i] = codes[i].len;
+	write_code_lengths(outfp, lengths);
 
-					if ((cur->left == 0) && (cur->right == 0)) {
+	bw->fp = outfp;
+	bw->buf = malloc(IO_BUF_SIZE);
+	bw->cap = IO_BUF_SIZE;
+	bw->pos = 0;
+	bw->acc = 0;
+	bw->nacc = 0;
+	bw->nbytes = 0;
+}
 
-						fprintf(outfp, "%c", cur->data);
-						
-						fflush(outfp);
-						cur = root;
-					}
-					if (nbits == 0)
-						return;
+// 남은 비트, 동기점 인덱스(index, index_size 바이트, 없으면 0), 전체 비트 수(8바이트, little-endian)를 출력
+// return value : 인코딩된 텍스트와 인덱스의 바이트 수
+static long long end_encoding(tBitWriter* bw, const unsigned char* index, size_t index_size) {
+	unsigned char tail[HUF_TAIL_SIZE];
+
+	// 전체 비트 수
+	uint64_t number = (uint64_t)(bw->nbytes + bw->pos) * 8 + bw->nacc;
+
+	// 남은 비트 (마지막 바이트는 0으로 채움)
+	while (bw->nacc > 0) {
+		bw->buf[bw->pos++] = bw->acc >> 56;
+		bw->acc <<= 8;
+		bw->nacc -= 8;
+	}
+	fwrite(bw->buf, 1, bw->pos, bw->fp);
+	bw->nbytes += bw->pos;
+
+	if (index_size) {
+		fwrite(index, 1, index_size, bw->fp);
+		bw->nbytes += index_size;
+	}
+
+	for (int i = 0; i < HUF_TAIL_SIZE; i++) tail[i] = number >> (8 * i);
+	fwrite(tail, 1, HUF_TAIL_SIZE, bw->fp);
+
+	free(bw->buf);
+	return bw->nbytes;
+}
+
+// 입력 텍스트 파일(infp)을 허프만 코드를 이용하여 출력 파일(outfp)로 인코딩
+// 코드 길이 헤더 + 비트열 + 전체 비트 수
+// return value : 인코딩된 텍스트의 바이트 수 (파일 크기와는 다름)
+long long encoding(tCode codes[], FILE* infp, FILE* outfp) {
+	unsigned char* in = malloc(IO_BUF_SIZE);
+	tBitWriter bw;
+	size_t n;
+
+	begin_encoding(&bw, codes, outfp);
+	while ((n = fread(in, 1, IO_BUF_SIZE, infp)) > 0) {
+		put_codes(&bw, codes, in, n);
+	}
+
+	free(in);
+	return end_encoding(&bw, 0, 0);
+}
+
+// 메모리(data)에 있는 텍스트를 허프만 코드를 이용하여 출력 파일(outfp)로 인코딩
+// encoding 함수와 같은 형식으로 출력
+// return value : 인코딩된 텍스트의 바이트 수 (파일 크기와는 다름)
+long long encoding_mem(tCode codes[], const unsigned char* data, size_t size, FILE* outfp) {
+	tBitWriter bw;
+
+	begin_encoding(&bw, codes, outfp);
+	put_codes(&bw, codes, data, size);
+	return end_encoding(&bw, 0, 0);
+}
+
+// 64비트 값을 하위 바이트부터 (little-endian) p에 저장
+static void store_le64(unsigned char* p, uint64_t v) {
+	for (int i = 0; i < 8; i++) p[i] = v >> (8 * i);
+}
+
+// p에서 64비트 값을 하위 바이트부터 (little-endian) 읽음
+static uint64_t load_le64(const unsigned char* p) {
+	uint64_t v = 0;
+	for (int i = 7; i >= 0; i--) v = (v << 8) | p[i];
+	return v;
+}
+
+// 메모리(data)에 있는 텍스트를 encoding_mem 함수와 같은 형식으로 인코딩하면서
+// 원본 interval 바이트마다 동기점(원본 위치, 비트 위치)을 기록하여 비트열과 전체 비트 수 사이에 저장
+// return value : 인코딩된 텍스트와 인덱스의 바이트 수 (파일 크기와는 다름)
+long long encoding_indexed(tCode codes[], const unsigned char* data, size_t size, size_t interval, FILE* outfp) {
+	size_t nsync = size ? (size - 1) / interval + 1 : 0;
+	unsigned char* index;
+	size_t index_size = nsync * SYNC_ENTRY_SIZE + SYNC_FOOTER_SIZE;
+	tBitWriter bw;
+
+	index = malloc(index_size);
+
+	begin_encoding(&bw, codes, outfp);
+	for (size_t k = 0; k < nsync; k++) {
+		size_t begin = k * interval;
+		size_t n = size - begin < interval ? size - begin : interval;
+
+		store_le64(index + k * SYNC_ENTRY_SIZE, begin);
+		store_le64(index + k * SYNC_ENTRY_SIZE + 8, (uint64_t)(bw.nbytes + bw.pos) * 8 + bw.nacc);
+		put_codes(&bw, codes, data + begin, n);
+	}
+
+	// 동기점 수, 원본 크기, magic
+	store_le64(index + nsync * SYNC_ENTRY_SIZE, nsync);
+	store_le64(index + nsync * SYNC_ENTRY_SIZE + 8, size);
+	memcpy(index + nsync * SYNC_ENTRY_SIZE + 16, SYNC_MAGIC, 4);
+
+	long long ret = end_encoding(&bw, index, index_size);
+	free(index);
+	return ret;
+}
+
+// 메모리(data)에 있는 텍스트를 허프만 코드를 이용하여 비트열로 인코딩하여 out에 저장
+// 헤더와 전체 비트 수는 저장하지 않음
+// out의 크기는 ENCODE_BOUND(size) 이상이어야 함
+// return value : 비트열의 비트 수
+uint64_t encoding_bits(const tCode codes[], const unsigned char* data, size_t size, unsigned char* out) {
+	tBitWriter bw;
+	uint64_t nbits;
+
+	bw.fp = 0;
+	bw.buf = out;
+	bw.cap = (size_t)-1;	// 출력 버퍼가 충분히 크므로 파일로 출력하지 않음
+	bw.pos = 0;
+	bw.acc = 0;
+	bw.nacc = 0;
+	bw.nbytes = 0;
+
+	put_codes(&bw, codes, data, size);
+
+	nbits = (uint64_t)bw.pos * 8 + bw.nacc;
+	while (bw.nacc > 0) {
+		out[bw.pos++] = bw.acc >> 56;
+		bw.acc <<= 8;
+		bw.nacc -= 8;
+	}
+	return nbits;
+}
+
+// 메모리 출력 버퍼(cap 바이트)에 코드 하나를 이어붙임
+static inline void put_code(tBitWriter* bw, tCode c) {
+	int room = 64 - bw->nacc;
+
+	if (c.len < room) {
+		bw->acc |= c.bits << (room - c.len);
+		bw->nacc += c.len;
+	}
+	else {
+		bw->acc |= c.bits >> (c.len - room);
+		assert(bw->pos + 8 <= bw->cap);
+		store_be64(bw->buf + bw->pos, bw->acc);
+		bw->pos += 8;
+		bw->nacc = c.len - room;
+		bw->acc = bw->nacc ? c.bits << (64 - bw->nacc) : 0;
+	}
+}
+
+// 메모리(data)에 있는 텍스트를 NUM_STREAMS개의 비트열로 나누어 인코딩하여 out에 저장
+// i번째 문자는 i % NUM_STREAMS번째 비트열에 저장
+// [점프 테이블 : 마지막을 제외한 비트열들의 바이트 수(4바이트씩)] [비트열 0] ... [비트열 NUM_STREAMS-1]
+// out의 크기는 STREAMS_BOUND(size) 이상이어야 함
+// 긴 코드의 문자가 한 비트열에 몰릴 수 있으므로 비트열별 비트 수를 먼저 세어 out 안의 위치를 정하고 제 위치에 직접 씀
+// return value : out에 저장한 바이트 수
+size_t encoding_streams(tCode codes[], const unsigned char* data, size_t size, unsigned char* out) {
+	tBitWriter bw[NUM_STREAMS];
+	uint64_t nbits[NUM_STREAMS] = {0,};
+	size_t offset = STREAMS_JUMP_SIZE;
+	size_t i;
+	int s;
+
+	for (i = 0; i + NUM_STREAMS <= size; i += NUM_STREAMS) {
+		nbits[0] += codes[data[i]].len;
+		nbits[1] += codes[data[i + 1]].len;
+		nbits[2] += codes[data[i + 2]].len;
+		nbits[3] += codes[data[i + 3]].len;
+	}
+	for (; i < size; i++) nbits[i % NUM_STREAMS] += codes[data[i]].len;
+
+	for (s = 0; s < NUM_STREAMS; s++) {
+		bw[s].fp = 0;
+		bw[s].buf = out + offset;
+		bw[s].cap = (nbits[s] + 7) / 8;
+		bw[s].pos = 0;
+		bw[s].acc = 0;
+		bw[s].nacc = 0;
+		bw[s].nbytes = 0;
+		if (s < NUM_STREAMS - 1) {
+			for (int k = 0; k < 4; k++) out[4 * s + k] = bw[s].cap >> (8 * k);
+		}
+		offset += bw[s].cap;
+	}
+	assert(offset <= STREAMS_BOUND(size));
+
+	for (i = 0; i + NUM_STREAMS <= size; i += NUM_STREAMS) {
+		put_code(&bw[0], codes[data[i]]);
+		put_code(&bw[1], codes[data[i + 1]]);
+		put_code(&bw[2], codes[data[i + 2]]);
+		put_code(&bw[3], codes[data[i + 3]]);
+	}
+	for (; i < size; i++) put_code(&bw[i % NUM_STREAMS], codes[data[i]]);
+
+	for (s = 0; s < NUM_STREAMS; s++) {
+		// 남은 비트 (마지막 바이트는 0으로 채움)
+		while (bw[s].nacc > 0) {
+			bw[s].buf[bw[s].pos++] = bw[s].acc >> 56;
+			bw[s].acc <<= 8;
+			bw[s].nacc -= 8;
+		}
+		assert(bw[s].pos == bw[s].cap);
+	}
+	return offset;
+}
+
+// 코드 길이로부터 디코딩 테이블을 생성
+// TABLE_BITS 이하의 코드는 table에서 바로 찾고, 긴 코드는 길이별 범위(first, count)로 찾음
+// return value : 0 성공, -1 코드 길이가 잘못된 경우
+static int make_decode_table(unsigned char lengths[], tDecodeTable* dt) {
+	tCode codes[256];
+
+	dt->max_len = canonical_first(lengths, 256, dt->count, dt->first);
+	if (dt->max_len < 0 || make_canonical_code(lengths, codes) < 0) return -1;
+
+	dt->index[0] = 0;
+	for (int len = 1; len <= MAX_CODE_LEN; len++) dt->index[len] = dt->index[len - 1] + dt->count[len - 1];
+	{
+		int pos[MAX_CODE_LEN + 1];
+		memcpy(pos, dt->index, sizeof(pos));
+		for (int i = 0; i < 256; i++) {
+			if (lengths[i]) dt->sorted[pos[lengths[i]]++] = i;
+		}
+	}
+
+	memset(dt->table, 0, sizeof(dt->table));
+	for (int i = 0; i < 256; i++) {
+		int len = lengths[i];
+		if (len == 0 || len > TABLE_BITS) continue;
+		// 이 코드로 시작하는 모든 TABLE_BITS 비트 패턴이 같은 심볼
+		unsigned first = (unsigned)codes[i].bits << (TABLE_BITS - len);
+		unsigned last = (unsigned)(codes[i].bits + 1) << (TABLE_BITS - len);
+		for (unsigned k = first; k < last; k++) {
+			dt->table[k].data = i;
+			dt->table[k].len = len;
+		}
+	}
+	return 0;
+}
+
+// 파일 끝에 저장된 전체 비트 수를 읽음 (magic으로 8바이트/이전 형식의 4바이트를 구분)
+// 읽은 뒤 파일 위치를 원래대로(코드 길이 헤더 다음) 돌려놓음
+// return value : 비트 수, 비트열보다 크거나 형식이 맞지 않는 경우 -1
+static long long read_bit_count(FILE* fp) {
+	off_t start = ftello(fp);
+	unsigned char magic[2], tail[HUF_TAIL_SIZE];
+	long long nbits = 0;
+	off_t end;
+	int width;
+
+	if (fseeko(fp, 0, SEEK_SET) != 0 || fread(magic, 1, 2, fp) != 2) return -1;
+	width = memcmp(magic, HUF_MAGIC_V1, 2) == 0 ? 4 : HUF_TAIL_SIZE;
+
+	if (fseeko(fp, -width, SEEK_END) != 0) return -1;
+	end = ftello(fp);
+	if (fread(tail, 1, width, fp) != (size_t)width) return -1;
+	for (int i = width - 1; i >= 0; i--) nbits = (nbits << 8) | tail[i];
+	if (width == 4) nbits = (int32_t)nbits;	// 이전 형식은 int
+
+	fseeko(fp, start, SEEK_SET);
+	if (nbits < 0 || (nbits + 7) / 8 > end - start) return -1;
+	return nbits;
+}
+
+// acc에 57비트 이상이 차도록 바이트 단위로 채움
+// 파일의 끝 이후는 0으로 채움 (남은 비트 수는 호출한 쪽에서 확인)
+static void refill(tBitReader* br) {
+	while (br->nacc <= 56) {
+		if (br->pos == br->end) {
+			br->end = fread(br->buf, 1, sizeof(br->buf), br->fp);
+			br->pos = 0;
+		}
+		if (br->pos < br->end) br->acc |= (uint64_t)br->buf[br->pos++] << (56 - br->nacc);
+		br->nacc += 8;
+	}
+}
+
+// 입력 파일(infp)을 코드 길이로부터 만든 룩업 테이블을 이용하여 출력 파일(out)로 디코딩
+// TABLE_BITS 비트를 한번에 살펴보고 심볼과 코드 길이를 얻음
+// decoding 함수와 같은 결과를 출력
+// return value : 0 성공, -1 코드 길이가 잘못되었거나 파일 끝의 비트 수가 맞지 않는 경우
+int decoding_table(unsigned char lengths[], FILE* infp, tOutput* out) {
+
+	long long nbits = read_bit_count(infp);
+	tDecodeTable* dt = malloc(sizeof(tDecodeTable));
+	tBitReader br;
+	unsigned char* outbuf;
+	size_t nout = 0;
+
+	if (nbits < 0 || make_decode_table(lengths, dt) < 0) {
+		free(dt);
+		return -1;
+	}
+	outbuf = malloc(IO_BUF_SIZE);
+
+	br.fp = infp;
+	br.pos = br.end = 0;
+	br.acc = 0;
+	br.nacc = 0;
+
+	while (nbits > 0) {
+		// 버퍼에 모아서 출력
+		if (nout == IO_BUF_SIZE) {
+			write_output(out, outbuf, nout);
+			nout = 0;
+		}
+		refill(&br);
+		tEntry* e = &dt->table[br.acc >> (64 - TABLE_BITS)];
+
+		if (e->len) {
+			// 마지막 코드가 비트 수를 넘어가면 트리 디코더처럼 출력하지 않음
+			if (e->len > nbits) break;
+			outbuf[nout++] = e->data;
+			br.acc <<= e->len;
+			br.nacc -= e->len;
+			nbits -= e->len;
+		}
+		else {
+			// 긴 코드 : 한 비트씩 늘려가며 길이별 코드 범위에 속하는지 확인
+			uint64_t code = br.acc >> (64 - TABLE_BITS);
+			int len = TABLE_BITS;
+			br.acc <<= TABLE_BITS;
+			br.nacc -= TABLE_BITS;
+			while (1) {
+				if (++len > dt->max_len || len > nbits) break;
+				if (br.nacc == 0) refill(&br);
+				code = (code << 1) | (br.acc >> 63);
+				br.acc <<= 1;
+				br.nacc--;
+				if (code - dt->first[len] < (uint64_t)dt->count[len]) break;
+			}
+			if (len > dt->max_len || len > nbits) break;
+			outbuf[nout++] = dt->sorted[dt->index[len] + (code - dt->first[len])];
+			nbits -= len;
+		}
+	}
+
+	write_output(out, outbuf, nout);
+	free(outbuf);
+	free(dt);
+	return 0;
+}
+
+// 64비트 값을 상위 바이트부터 (big-endian) p에서 읽음
+static uint64_t load_be64(const unsigned char* p) {
+	uint64_t v;
+#if defined(__GNUC__) && __BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__
+	memcpy(&v, p, 8);
+	v = __builtin_bswap64(v);
+#else
+	v = 0;
+	for (int i = 0; i < 8; i++) v = (v << 8) | p[i];
+#endif
+	return v;
+}
+
+// 메모리에 있는 비트열을 읽는 상태
+typedef struct
+{
+	const unsigned char	*p;		// 다음에 읽을 바이트
+	const unsigned char	*end;	// 비트열의 끝
+	uint64_t			acc;	// 읽어들인 비트 (상위 비트부터)
+	int					nacc;	// acc에 들어있는 비트 수
+	size_t				pad;	// 비트열의 끝 이후로 채운 0 바이트 수
+} tMemReader;
+
+static void mem_reader_init(tMemReader* mr, const unsigned char* in, size_t in_size) {
+	mr->p = in;
+	mr->end = in + in_size;
+	mr->acc = 0;
+	mr->nacc = 0;
+	mr->pad = 0;
+}
+
+// 비트열의 끝을 넘어서 읽었는지 확인
+static int mem_reader_overrun(tMemReader* mr) {
+	return (uint64_t)mr->pad * 8 > (uint64_t)mr->nacc;
+}
+
+// acc에 57비트 이상 채움
+// 남은 입력이 8바이트 이상이면 한번에 읽고, 아니면 한 바이트씩 (끝 이후는 0)
+static inline void mem_refill(tMemReader* mr) {
+	if (mr->end - mr->p >= 8) {
+		mr->acc |= load_be64(mr->p) >> mr->nacc;
+		mr->p += (63 - mr->nacc) >> 3;
+		mr->nacc |= 56;
+	}
+	else {
+		while (mr->nacc <= 56) {
+			if (mr->p < mr->end) mr->acc |= (uint64_t)*mr->p++ << (56 - mr->nacc);
+			else mr->pad++;
+			mr->nacc += 8;
+		}
+	}
+}
+
+// TABLE_BITS보다 긴 코드 하나를 디코딩 (slow path)
+// 길이를 늘려가며 길이별 코드 범위에 속하는지 확인
+// return value : 문자, 잘못된 코드인 경우 -1
+static int decode_long(const tDecodeTable* dt, tMemReader* mr) {
+	uint64_t code;
+	int len;
+
+	if (dt->max_len <= mr->nacc) {
+		// acc에 가장 긴 코드까지 들어있음
+		for (len = TABLE_BITS + 1; len <= dt->max_len; len++) {
+			code = mr->acc >> (64 - len);
+			if (code - dt->first[len] < (uint64_t)dt->count[len]) {
+				mr->acc <<= len;
+				mr->nacc -= len;
+				return dt->sorted[dt->index[len] + (code - dt->first[len])];
+			}
+		}
+		return -1;
+	}
+
+	// acc보다 긴 코드 : 한 비트씩 읽음
+	code = 0;
+	for (len = 1; len <= dt->max_len; len++) {
+		if (mr->nacc == 0) {
+			if (mr->p < mr->end) mr->acc = (uint64_t)*mr->p++ << 56;
+			else mr->pad++;
+			mr->nacc = 8;
+		}
+		code = (code << 1) | (mr->acc >> 63);
+		mr->acc <<= 1;
+		mr->nacc--;
+		if (code - dt->first[len] < (uint64_t)dt->count[len]) {
+			return dt->sorted[dt->index[len] + (code - dt->first[len])];
+		}
+	}
+	return -1;
+}
+
+// acc에 들어있는 비트로 문자 하나를 디코딩 (acc에 max_len 비트 이상 있어야 함)
+// return value : 문자, 잘못된 코드인 경우 -1
+static inline int decode_fast(const tDecodeTable* dt, tMemReader* mr) {
+	tEntry e = dt->table[mr->acc >> (64 - TABLE_BITS)];
+
+	if (e.len) {
+		mr->acc <<= e.len;
+		mr->nacc -= e.len;
+		return e.data;
+	}
+	return decode_long(dt, mr);
+}
+
+// 필요하면 acc를 채우고 문자 하나를 디코딩
+// return value : 문자, 잘못된 코드인 경우 -1
+static inline int decode_symbol(const tDecodeTable* dt, tMemReader* mr) {
+	if (mr->nacc < dt->max_len) mem_refill(mr);
+	if (mr->nacc < dt->max_len) return decode_long(dt, mr);
+	return decode_fast(dt, mr);
+}
+
+// 비트열 읽기 상태(mr)에서부터 만들어 둔 룩업 테이블(dt)을 이용하여
+// out_size개의 문자로 디코딩하여 out에 저장 (mr은 디코딩한 다음 위치가 됨)
+// return value : 0 성공, -1 비트열이 잘못된 경우
+static int decode_from_reader(const tDecodeTable* dt, tMemReader* mr, unsigned char* out, size_t out_size) {
+	size_t i = 0;
+	int c0, c1, bad = 0;
+
+	// 빠른 경로 : 8바이트씩 채우고, 가장 긴 코드 두개가 들어가면 두 문자를 디코딩
+	if (dt->max_len <= 28) {
+		for (; i + 2 <= out_size && mr->end - mr->p >= 8; i += 2) {
+			mem_refill(mr);
+			c0 = decode_fast(dt, mr);
+			c1 = decode_fast(dt, mr);
+			if ((c0 | c1) < 0) {
+				bad = 1;
+				break;
+			}
+			out[i] = c0;
+			out[i + 1] = c1;
+		}
+	}
+
+	for (; !bad && i < out_size; i++) {
+		if ((c0 = decode_symbol(dt, mr)) < 0) bad = 1;
+		else out[i] = c0;
+	}
+
+	// 잘못된 코드를 만났거나 비트열의 끝을 넘어서 읽은 경우
+	if (bad || mem_reader_overrun(mr)) return -1;
+	return 0;
+}
+
+// 메모리에 있는 비트열(in, in_size 바이트)을 만들어 둔 룩업 테이블(dt)을 이용하여
+// out_size개의 문자로 디코딩하여 out에 저장
+// return value : 0 성공, -1 비트열이 잘못된 경우
+static int decode_with_table(const tDecodeTable* dt, const unsigned char* in, size_t in_size, unsigned char* out, size_t out_size) {
+	tMemReader mr;
+
+	mem_reader_init(&mr, in, in_size);
+	return decode_from_reader(dt, &mr, out, out_size);
+}
+
+// 메모리에 있는 비트열(in, in_size 바이트)을 코드 길이로부터 만든 룩업 테이블을 이용하여
+// out_size개의 문자로 디코딩하여 out에 저장
+// return value : 0 성공, -1 코드 길이나 비트열이 잘못된 경우
+int decoding_mem(unsigned char lengths[], const unsigned char* in, size_t in_size, unsigned char* out, size_t out_size) {
+	tDecodeTable* dt = malloc(sizeof(tDecodeTable));
+	int ret = -1;
+
+	if (make_decode_table(lengths, dt) == 0) ret = decode_with_table(dt, in, in_size, out, out_size);
+
+	free(dt);
+	return ret;
+}
+
+// NUM_STREAMS개의 비트열로 나누어 인코딩된 데이터(in, in_size 바이트)를 out_size개의 문자로 디코딩
+// 한 반복에서 비트열마다 문자를 디코딩하므로 비트열들의 디코딩이 서로를 기다리지 않음
+// return value : 0 성공, -1 코드 길이나 비트열이 잘못된 경우
+int decoding_streams(unsigned char lengths[], const unsigned char* in, size_t in_size, unsigned char* out, size_t out_size) {
+	tDecodeTable* dt;
+	tMemReader mr[NUM_STREAMS];
+	size_t offset = STREAMS_JUMP_SIZE;
+	size_t i = 0;
+	int s, c0, c1, c2, c3, bad = 0;
+
+	// 점프 테이블 : 마지막을 제외한 비트열들의 바이트 수
+	if (in_size < STREAMS_JUMP_SIZE) return -1;
+	for (s = 0; s < NUM_STREAMS; s++) {
+		size_t n = in_size - offset;
+		if (s < NUM_STREAMS - 1) {
+			const unsigned char* q = in + 4 * s;
+			n = q[0] | (q[1] << 8) | (q[2] << 16) | ((size_t)q[3] << 24);
+			if (n > in_size - offset) return -1;
+		}
+		mem_reader_init(&mr[s], in + offset, n);
+		offset += n;
+	}
+
+	dt = malloc(sizeof(tDecodeTable));
+	if (make_decode_table(lengths, dt) < 0) {
+		free(dt);
+		return -1;
+	}
+
+	// 빠른 경로 : 모든 비트열에 8바이트 이상 남아 있는 동안
+	// i번째 문자는 i % NUM_STREAMS번째 비트열
+	if (dt->max_len <= 28) {
+		int twice = 2 * NUM_STREAMS;
+		for (; i + twice <= out_size; i += twice) {
+			if (mr[0].end - mr[0].p < 8 || mr[1].end - mr[1].p < 8
+				|| mr[2].end - mr[2].p < 8 || mr[3].end - mr[3].p < 8) break;
+			mem_refill(&mr[0]);
+			mem_refill(&mr[1]);
+			mem_refill(&mr[2]);
+			mem_refill(&mr[3]);
+			c0 = decode_fast(dt, &mr[0]);
+			c1 = decode_fast(dt, &mr[1]);
+			c2 = decode_fast(dt, &mr[2]);
+			c3 = decode_fast(dt, &mr[3]);
+			out[i] = c0;
+			out[i + 1] = c1;
+			out[i + 2] = c2;
+			out[i + 3] = c3;
+			bad |= c0 | c1 | c2 | c3;
+			c0 = decode_fast(dt, &mr[0]);
+			c1 = decode_fast(dt, &mr[1]);
+			c2 = decode_fast(dt, &mr[2]);
+			c3 = decode_fast(dt, &mr[3]);
+			out[i + 4] = c0;
+			out[i + 5] = c1;
+			out[i + 6] = c2;
+			out[i + 7] = c3;
+			bad |= c0 | c1 | c2 | c3;
+			if (bad < 0) break;
+		}
+		bad = bad < 0;
+	}
+
+	for (; !bad && i < out_size; i++) {
+		if ((c0 = decode_symbol(dt, &mr[i % NUM_STREAMS])) < 0) bad = 1;
+		else out[i] = c0;
+	}
+
+	free(dt);
+
+	for (s = 0; s < NUM_STREAMS; s++) {
+		if (mem_reader_overrun(&mr[s])) bad = 1;
+	}
+	return bad ? -1 : 0;
+}
+
+// 동기점 인덱스가 있는 허프만 형식 파일(in, in_size 바이트)의 각 부분을 찾음
+// start : 비트열의 시작 위치, nbits : 비트열의 비트 수, index : 첫번째 동기점의 위치, nsync : 동기점 수, raw_size : 원본 크기
+// return value : 0 성공, -1 형식이 맞지 않거나 인덱스가 없는 경우
+static int find_sync_index(const unsigned char* in, size_t in_size, unsigned char lengths[], size_t* start,
+	uint64_t* nbits, const unsigned char** index, uint64_t* nsync, uint64_t* raw_size) {
+	int n;
+
+	if (in_size < 2 || memcmp(in, HUF_MAGIC, 2) != 0) return -1;
+	n = unpack_code_lengths(in + 2, in_size - 2, lengths);
+	if (n < 0 || in_size < 2 + (size_t)n + SYNC_FOOTER_SIZE + HUF_TAIL_SIZE) return -1;
+
+	// 비트열 다음부터 전체 비트 수 앞까지가 인덱스
+	*start = 2 + n;
+	*nbits = load_le64(in + in_size - HUF_TAIL_SIZE);
+	const unsigned char* footer = in + in_size - HUF_TAIL_SIZE - SYNC_FOOTER_SIZE;
+	if (memcmp(footer + 16, SYNC_MAGIC, 4) != 0) return -1;
+	*nsync = load_le64(footer);
+	*raw_size = load_le64(footer + 8);
+
+	size_t index_space = in_size - HUF_TAIL_SIZE - SYNC_FOOTER_SIZE - *start;
+	if ((*nsync == 0) != (*raw_size == 0) || *nsync > index_space / SYNC_ENTRY_SIZE) return -1;	// 빈 원본만 동기점이 없음
+	if ((*nbits + 7) / 8 != index_space - *nsync * SYNC_ENTRY_SIZE) return -1;
+	*index = footer - *nsync * SYNC_ENTRY_SIZE;
+	return 0;
+}
+
+// 동기점 인덱스가 있는 허프만 형식 파일(in, in_size 바이트)의 원본 크기
+// return value : 원본 바이트 수, 형식이 맞지 않거나 인덱스가 없는 경우 -1
+long long indexed_decoded_size(const unsigned char* in, size_t in_size) {
+	unsigned char lengths[256];
+	const unsigned char* index;
+	uint64_t nbits, nsync, raw_size;
+	size_t start;
+
+	if (find_sync_index(in, in_size, lengths, &start, &nbits, &index, &nsync, &raw_size) < 0) return -1;
+	return raw_size;
+}
+
+// 동기점 인덱스가 있는 허프만 형식 파일(in, in_size 바이트, 메모리에 올린 파일 전체)에서
+// 원본의 offset 바이트부터 length 바이트를 디코딩하여 out에 저장
+// offset 이전의 마지막 동기점부터 디코딩하므로 파일 크기와 관계없이 동기점 간격 + length 만큼만 읽음
+// return value : 디코딩한 바이트 수 (원본의 끝에서 잘림), 형식이 맞지 않거나 인덱스가 없는 경우 -1
+long long decoding_range(const unsigned char* in, size_t in_size, uint64_t offset, size_t length, unsigned char* out) {
+	unsigned char lengths[256];
+	const unsigned char* index;
+	uint64_t nbits, nsync, raw_size;
+	size_t start;
+
+	if (find_sync_index(in, in_size, lengths, &start, &nbits, &index, &nsync, &raw_size) < 0) return -1;
+	if (offset >= raw_size) return 0;
+	if (length > raw_size - offset) length = raw_size - offset;
+
+	// offset 이하인 마지막 동기점 (이진 탐색)
+	uint64_t lo = 0, hi = nsync - 1;
+	if (load_le64(index) != 0) return -1;
+	while (lo < hi) {
+		uint64_t mid = lo + (hi - lo + 1) / 2;
+		if (load_le64(index + mid * SYNC_ENTRY_SIZE) <= offset) lo = mid;
+		else hi = mid - 1;
+	}
+	uint64_t sync_pos = load_le64(index + lo * SYNC_ENTRY_SIZE);
+	uint64_t sync_bit = load_le64(index + lo * SYNC_ENTRY_SIZE + 8);
+	if (sync_bit > nbits) return -1;
+
+	tDecodeTable* dt = malloc(sizeof(tDecodeTable));
+	tMemReader mr;
+	unsigned char skip_buf[4096];
+	uint64_t skip = offset - sync_pos;
+	int bad = dt == 0 || make_decode_table(lengths, dt) < 0;
+
+	// 동기점의 비트 위치부터 읽음 (바이트 안의 앞쪽 비트는 버림)
+	mem_reader_init(&mr, in + start + sync_bit / 8, (nbits + 7) / 8 - sync_bit / 8);
+	if (!bad && sync_bit % 8) {
+		mem_refill(&mr);
+		mr.acc <<= sync_bit % 8;
+		mr.nacc -= sync_bit % 8;
+	}
+
+	// 동기점부터 offset까지는 디코딩하여 버림
+	while (!bad && skip > 0) {
+		size_t n = skip < sizeof(skip_buf) ? skip : sizeof(skip_buf);
+		if (decode_from_reader(dt, &mr, skip_buf, n) < 0) bad = 1;
+		skip -= n;
+	}
+	if (!bad && decode_from_reader(dt, &mr, out, length) < 0) bad = 1;
+
+	free(dt);
+	return bad ? -1 : (long long)length;
+}
+
+// x * log2(x) (x = 0이면 0)
+static double nlog2n(double x) {
+	return x > 0 ? x * log2(x) : 0;
+}
+
+// 빈도표(freq)의 문자들을 엔트로피만큼의 비트로 인코딩할 때의 비트 수 (허프만 코드 길이의 추정값)
+static double entropy_bits(const long long freq[]) {
+	double total = 0, sum = 0;
+
+	for (int i = 0; i < 256; i++) {
+		total += freq[i];
+		sum += nlog2n(freq[i]);
+	}
+	return nlog2n(total) - sum;
+}
+
+// 두 빈도표를 합쳤을 때의 엔트로피 비트 수
+static double merged_entropy_bits(const long long a[], const long long b[]) {
+	double total = 0, sum = 0;
+
+	for (int i = 0; i < 256; i++) {
+		double f = (double)a[i] + b[i];
+		total += f;
+		sum += nlog2n(f);
+	}
+	return nlog2n(total) - sum;
+}
+
+// 문맥(앞 문자)별 빈도표를 비슷한 것끼리 묶어서 문맥별 클러스터 번호를 map에 저장
+// 두 클러스터를 합쳐서 늘어나는 비트 수가 코드 길이 표 하나의 크기(ORDER1_TABLE_BITS)보다 작은 동안
+// 가장 적게 늘어나는 쌍부터 합침 (빈도가 0인 문맥은 0번 클러스터)
+// cluster_freq : 클러스터별 빈도표를 저장 (256개)
+// return value : 클러스터 수 (1 이상)
+static int cluster_contexts(long long ctx_freq[][256], unsigned char map[], long long cluster_freq[][256]) {
+	int members[256];		// 클러스터 번호별 대표 문맥 (합쳐진 클러스터는 -1)
+	double cost[256];		// 클러스터별 엔트로피 비트 수
+	double* delta = malloc(sizeof(double) * 256 * 256);	// 두 클러스터를 합칠 때 늘어나는 비트 수
+	int owner[256];			// 문맥별 클러스터 (대표 문맥)
+	int k = 0, nclusters;
+
+	// 빈도가 있는 문맥마다 클러스터 하나
+	for (int c = 0; c < 256; c++) {
+		long long total = 0;
+		owner[c] = -1;
+		for (int i = 0; i < 256; i++) {
+			cluster_freq[k][i] = ctx_freq[c][i];
+			total += ctx_freq[c][i];
+		}
+		if (total == 0) continue;
+		owner[c] = k;
+		members[k] = k;
+		cost[k] = entropy_bits(cluster_freq[k]);
+		k++;
+	}
+	nclusters = k;
+
+	for (int a = 0; a < k; a++) {
+		for (int b = a + 1; b < k; b++) {
+			delta[a * 256 + b] = merged_entropy_bits(cluster_freq[a], cluster_freq[b]) - cost[a] - cost[b];
+		}
+	}
+
+	while (nclusters > 1) {
+		int best_a = -1, best_b = -1;
+		double best = ORDER1_TABLE_BITS;
+
+		for (int a = 0; a < k; a++) {
+			if (members[a] < 0) continue;
+			for (int b = a + 1; b < k; b++) {
+				if (members[b] >= 0 && delta[a * 256 + b] < best) {
+					best = delta[a * 256 + b];
+					best_a = a;
+					best_b = b;
+				}
+			}
+		}
+		if (best_a < 0) break;
+
+		// b를 a에 합침
+		for (int i = 0; i < 256; i++) cluster_freq[best_a][i] += cluster_freq[best_b][i];
+		cost[best_a] = entropy_bits(cluster_freq[best_a]);
+		members[best_b] = -1;
+		for (int c = 0; c < 256; c++) {
+			if (owner[c] == best_b) owner[c] = best_a;
+		}
+		nclusters--;
+
+		for (int x = 0; x < k; x++) {
+			if (members[x] < 0 || x == best_a) continue;
+			int a = x < best_a ? x : best_a, b = x < best_a ? best_a : x;
+			delta[a * 256 + b] = merged_entropy_bits(cluster_freq[a], cluster_freq[b]) - cost[a] - cost[b];
+		}
+	}
+	free(delta);
+
+	// 남은 클러스터에 0부터 번호를 다시 매김
+	int number[256];
+	nclusters = 0;
+	for (int a = 0; a < k; a++) {
+		if (members[a] < 0) continue;
+		number[a] = nclusters;
+		if (nclusters != a) memcpy(cluster_freq[nclusters], cluster_freq[a], sizeof(long long) * 256);
+		nclusters++;
+	}
+	for (int c = 0; c < 256; c++) map[c] = owner[c] < 0 ? 0 : number[owner[c]];
+
+	if (nclusters == 0) {
+		memset(cluster_freq[0], 0, sizeof(long long) * 256);
+		nclusters = 1;
+	}
+	return nclusters;
+}
+
+// 메모리(data)에 있는 텍스트를 order-1 문맥 모델로 인코딩하여 출력 파일(outfp)에 저장
+// 앞 문자(문맥)가 속한 클러스터의 허프만 코드로 각 문자를 인코딩 (첫 문자의 문맥은 0)
+// max_len : 코드 길이 제한 (0이면 제한 없음)
+// return value : 출력한 바이트 수, 코드 길이 제한을 만족할 수 없는 경우 -1
+long long encoding_order1(const unsigned char* data, size_t size, int max_len, FILE* outfp) {
+	long long (*ctx_freq)[256] = calloc(256, sizeof(long long[256]));
+	long long (*cluster_freq)[256] = malloc(sizeof(long long[256]) * 256);
+	tCode (*codes)[256] = malloc(sizeof(tCode[256]) * 256);
+	unsigned char map[256];
+	unsigned char header[2 + 8 + 2];
+	unsigned char packed[1 + 256];
+	long long written = 0;
+	int nclusters, error = 0;
+	tBitWriter bw;
+
+	// 문맥별 빈도
+	for (size_t i = 0; i < size; i++) ctx_freq[i ? data[i - 1] : 0][data[i]]++;
+	nclusters = cluster_contexts(ctx_freq, map, cluster_freq);
+
+	// 헤더 : magic, 원본 크기, 클러스터 수, 문맥별 클러스터 번호
+	memcpy(header, ORDER1_MAGIC, 2);
+	for (int i = 0; i < 8; i++) header[2 + i] = (uint64_t)size >> (8 * i);
+	header[10] = nclusters & 0xff;
+	header[11] = nclusters >> 8;
+	fwrite(header, 1, sizeof(header), outfp);
+	fwrite(map, 1, 256, outfp);
+	written += sizeof(header) + 256;
+
+	// 클러스터별 코드 길이
+	for (int k = 0; k < nclusters && !error; k++) {
+		long long* freq = cluster_freq[k];
+		unsigned char lengths[256];
+
+		tTree* tree = make_huffman_tree(freq);
+		get_code_lengths(tree, lengths);
+		destroyTree(tree);
+
+		if (max_len > 0 && max_code_length(lengths) > max_len
+			&& get_limited_code_lengths(freq, max_len, lengths) < 0) error = 1;
+		else if (make_canonical_code(lengths, codes[k]) < 0) error = 1;
+
+		int n = pack_code_lengths(lengths, packed);
+		fwrite(packed, 1, n, outfp);
+		written += n;
+	}
+
+	if (!error) {
+		// 비트열 (put_codes와 같은 방법, 문자마다 문맥의 코드 표를 선택)
+		uint64_t acc = 0;
+		int nacc = 0, prev = 0;
+
+		bw.fp = outfp;
+		bw.buf = malloc(IO_BUF_SIZE);
+		bw.cap = IO_BUF_SIZE;
+		bw.pos = 0;
+		bw.nbytes = 0;
+
+		for (size_t i = 0; i < size; i++) {
+			tCode c = codes[map[prev]][data[i]];
+			int room = 64 - nacc;
+
+			prev = data[i];
+			if (c.len < room) {
+				acc |= c.bits << (room - c.len);
+				nacc += c.len;
+			}
+			else {
+				acc |= c.bits >> (c.len - room);
+				store_be64(bw.buf + bw.pos, acc);
+				bw.pos += 8;
+				nacc = c.len - room;
+				acc = nacc ? c.bits << (64 - nacc) : 0;
+
+				if (bw.pos == bw.cap) {
+					fwrite(bw.buf, 1, bw.pos, outfp);
+					bw.nbytes += bw.pos;
+					bw.pos = 0;
+				}
+			}
+		}
+
+		// 남은 비트 (마지막 바이트는 0으로 채움)
+		while (nacc > 0) {
+			bw.buf[bw.pos++] = acc >> 56;
+			acc <<= 8;
+			nacc -= 8;
+		}
+		fwrite(bw.buf, 1, bw.pos, outfp);
+		written += bw.nbytes + bw.pos;
+		free(bw.buf);
+	}
+
+	free(ctx_freq);
+	free(cluster_freq);
+	free(codes);
+	return error ? -1 : written;
+}
+
+// order-1 형식 파일(in, in_size 바이트)의 원본 크기
+// return value : 원본 바이트 수, 형식이 맞지 않는 경우 -1
+long long order1_decoded_size(const unsigned char* in, size_t in_size) {
+	uint64_t size = 0;
+
+	if (in_size < ORDER1_HEADER_SIZE || memcmp(in, ORDER1_MAGIC, 2) != 0) return -1;
+	for (int i = 0; i < 8; i++) size |= (uint64_t)in[2 + i] << (8 * i);
+	if (size > (uint64_t)1 << 62) return -1;
+	return size;
+}
+
+// order-1 형식 파일(in, in_size 바이트)을 디코딩하여 out(out_size 바이트)에 저장
+// 앞 문자(문맥)가 속한 클러스터의 룩업 테이블로 각 문자를 디코딩
+// max_len : 허용하는 코드 길이의 최대값
+// return value : 0 성공, -1 형식이 맞지 않는 경우
+int decoding_order1(const unsigned char* in, size_t in_size, unsigned char* out, size_t out_size, int max_len) {
+	const unsigned char* map = in + 12;
+	tDecodeTable* dt;
+	tMemReader mr;
+	size_t offset = ORDER1_HEADER_SIZE;
+	int nclusters, bad = 0, prev = 0;
+
+	if (order1_decoded_size(in, in_size) != (long long)out_size) return -1;
+	nclusters = in[10] | (in[11] << 8);
+	if (nclusters < 1 || nclusters > 256) return -1;
+	for (int c = 0; c < 256; c++) {
+		if (map[c] >= nclusters) return -1;
+	}
+
+	// 클러스터별 디코딩 테이블
+	dt = malloc(sizeof(tDecodeTable) * nclusters);
+	for (int k = 0; k < nclusters && !bad; k++) {
+		unsigned char lengths[256];
+		int n = unpack_code_lengths(in + offset, in_size - offset, lengths);
+
+		if (n < 0 || max_code_length(lengths) > max_len || make_decode_table(lengths, &dt[k]) < 0) bad = 1;
+		else offset += n;
+	}
+
+	if (!bad) {
+		mem_reader_init(&mr, in + offset, in_size - offset);
+		for (size_t i = 0; i < out_size; i++) {
+			int c = decode_symbol(&dt[map[prev]], &mr);
+			if (c < 0) {
+				bad = 1;
+				break;
+			}
+			out[i] = c;
+			prev = c;
+		}
+		if (mem_reader_overrun(&mr)) bad = 1;
+	}
+
+	free(dt);
+	return bad ? -1 : 0;
+}
+
+// 입력 파일(infp)을 허프만 트리를 이용하여 출력 파일(out)로 디코딩 (버퍼에 모아서 출력)
+void decoding(tTree* tree, FILE* infp, tOutput* out) {
+	
+	long long nbits = read_bit_count(infp);
+	const tNode* nodes = tree->nodes;
+	int cur = tree->root;
+	unsigned char outbuf[IO_BUF_SIZE];
+	int nout = 0;
+
+	if (nbits <= 0) return;
+
+	char strstr[IO_BUF_SIZE];
+
+	while (nbits > 0) {
+
+		int end = fread(strstr, 1, IO_BUF_SIZE, infp);
+		if (end == 0) {
+			break;
+		}
+		else {
+
+			for (int i = 0; i < end && nbits > 0; i++) {
+				for (int j = 0; j < 8; j++) {
+					if ((char)(strstr[i] & 0x80) == 0) {
+
+						cur = nodes[cur].left;
+					}
+
+					else
+						cur = nodes[cur].right;
+
+					strstr[i] = strstr[i] << 1;
+					nbits--;
+
+					// 코드에 없는 비트열
+					if (cur == NO_CHILD) {
+						nbits = 0;
+						break;
+					}
+
+					if ((nodes[cur].left == NO_CHILD) && (nodes[cur].right == NO_CHILD)) {
+
+						// 버퍼에 모아서 출력
+						outbuf[nout++] = nodes[cur].data;
+						if (nout == IO_BUF_SIZE) {
+							write_output(out, outbuf, nout);
+							nout = 0;
+						}
+						cur = tree->root;
+					}
+					if (nbits == 0)
+						break;
+				}
+			}
+		}
+	}
+
+	write_output(out, outbuf, nout);
+}
+
+// 입력 파일(infp)을 디코딩 전용 트리를 이용하여 출력 파일(out)로 디코딩
+// 한 비트마다 작은 배열에서 자식 쌍 하나를 읽음 (포인터를 따라가지 않음)
+// decoding 함수와 같은 결과를 출력
+void decoding_flat(tFlatTree* flat, FILE* infp, tOutput* out) {
+	long long nbits = read_bit_count(infp);
+	const uint16_t (*child)[2] = (const uint16_t (*)[2])flat->child;
+	unsigned char* inbuf;
+	unsigned char* outbuf;
+	int nout = 0;
+	unsigned cur = 0;
+
+	if (nbits <= 0 || flat->count == 0) return;
+
+	inbuf = malloc(IO_BUF_SIZE);
+	outbuf = malloc(IO_BUF_SIZE);
+
+	while (nbits > 0) {
+		int end = fread(inbuf, 1, IO_BUF_SIZE, infp);
+		if (end == 0) break;
+
+		for (int i = 0; i < end && nbits > 0; i++) {
+			unsigned byte = inbuf[i];
+			int n = nbits < 8 ? nbits : 8;
+
+			for (int j = 7; j >= 8 - n; j--) {
+				cur = child[cur][(byte >> j) & 1];
+				if (cur & FLAT_LEAF) {
+					outbuf[nout++] = cur & 0xff;
+					if (nout == IO_BUF_SIZE) {
+						write_output(out, outbuf, nout);
+						nout = 0;
+					}
+					cur = 0;
+				}
+				// 코드에 없는 비트열
+				else if (cur == 0) {
+					n = nbits = 0;
+					break;
+				}
+			}
+			nbits -= n;
+		}
+	}
+
+	write_output(out, outbuf, nout);
+	free(inbuf);
+	free(outbuf);
+}
+
+// 버퍼 API의 재사용 가능한 상태 (호출마다 할당하지 않음)
+struct Codec
+{
+	tDecodeTable	dt;			// 디코딩 테이블
+	tCode			codes[256];	// 문자별 허프만 코드
+};
+
+// 키 배열(a)의 i번째 원소를 end 이전의 최대힙 안에서 내림
+static void sift_down_keys(uint64_t a[], int i, int end) {
+	uint64_t v = a[i];
+
+	while (2 * i + 1 < end) {
+		int child = 2 * i + 1;
+		if (child + 1 < end && a[child + 1] > a[child]) child++;
+		if (a[child] <= v) break;
+		a[i] = a[child];
+		i = child;
+	}
+	a[i] = v;
+}
+
+// 키 배열(a)을 오름차순으로 정렬 (힙 정렬, 메모리를 할당하지 않음)
+static void sort_keys(uint64_t a[], int n) {
+	for (int i = n / 2 - 1; i >= 0; i--) sift_down_keys(a, i, n);
+	for (int end = n - 1; end > 0; end--) {
+		uint64_t temp = a[0];
+		a[0] = a[end];
+		a[end] = temp;
+		sift_down_keys(a, 0, end);
+	}
+}
+
+// 빈도 순으로 정렬된 가중치(A, n >= 2개)를 같은 자리의 최적 코드 길이로 바꿈 (트리와 힙을 만들지 않음)
+// 배열 안에서 부모 번호, 깊이, 코드 길이를 차례로 계산 (Moffat-Katajainen, O(n))
+// calc_code_lengths, calc_wide_code_lengths 함수에서 호출
+static void sorted_code_lengths(uint64_t A[], int n) {
+	// 1. 내부 노드의 가중치를 만들면서 자식의 자리에 부모 번호를 저장
+	uint64_t root = 0, leaf = 2;
+	A[0] += A[1];
+	for (int next = 1; next < n - 1; next++) {
+		if (leaf >= (uint64_t)n || A[root] < A[leaf]) {
+			A[next] = A[root];
+			A[root++] = next;
+		}
+		else A[next] = A[leaf++];
+
+		if (leaf >= (uint64_t)n || (root < (uint64_t)next && A[root] < A[leaf])) {
+			A[next] += A[root];
+			A[root++] = next;
+		}
+		else A[next] += A[leaf++];
+	}
+
+	// 2. 부모 번호를 내부 노드의 깊이로 바꿈
+	A[n - 2] = 0;
+	for (int next = n - 3; next >= 0; next--) A[next] = A[A[next]] + 1;
+
+	// 3. 깊이별 내부 노드 수로부터 leaf의 깊이(코드 길이)를 구함
+	int avail = 1, used = 0, depth = 0;
+	int r = n - 2, next = n - 1;
+	while (avail > 0) {
+		while (r >= 0 && A[r] == (uint64_t)depth) {
+			used++;
+			r--;
+		}
+		while (avail > used) {
+			A[next--] = depth;
+			avail--;
+		}
+		avail = 2 * used;
+		depth++;
+		used = 0;
+	}
+}
+
+// 빈도(freq)로부터 최적의 코드 길이를 구하여 lengths에 저장 (트리와 힙을 만들지 않음)
+// 빈도 순으로 정렬한 다음 sorted_code_lengths 함수로 계산
+// 빈도가 0인 문자는 코드 길이 0, 문자가 하나뿐이면 코드 길이 1
+static void calc_code_lengths(const long long freq[], unsigned char lengths[]) {
+	uint64_t keys[256];
+	uint64_t A[256];
+	int n = 0;
+
+	memset(lengths, 0, 256);
+	for (int i = 0; i < 256; i++) {
+		if (freq[i]) keys[n++] = ((uint64_t)freq[i] << 8) | i;
+	}
+	if (n == 0) return;
+	if (n == 1) {
+		lengths[keys[0] & 0xff] = 1;
+		return;
+	}
+	sort_keys(keys, n);
+	for (int i = 0; i < n; i++) A[i] = keys[i] >> 8;
+
+	sorted_code_lengths(A, n);
+	for (int i = 0; i < n; i++) lengths[keys[i] & 0xff] = A[i];
+}
+
+// 버퍼 API의 상태를 생성
+// return value : 상태의 포인터, 메모리가 부족한 경우 NULL
+tCodec* create_codec(void) {
+	return malloc(sizeof(tCodec));
+}
+
+// 버퍼 API의 상태 메모리 해제
+void destroy_codec(tCodec* codec) {
+	free(codec);
+}
+
+// size 바이트를 압축했을 때 출력의 최대 크기
+size_t compress_bound(size_t size) {
+	return CODEC_HEADER_SIZE + 1 + 256 + ENCODE_BOUND(size);
+}
+
+// 메모리(src, src_size 바이트)를 압축하여 dst(dst_cap 바이트)에 저장
+// [원본 크기(4), 비트 수(4), 코드 길이(pack_code_lengths 형식), 비트열] (블록 형식의 블록 하나와 같음)
+// return value : dst에 저장한 바이트 수, dst가 작거나 src가 CODEC_MAX_SIZE보다 크거나 코드를 만들 수 없는 경우 -1
+long long compress_mem(tCodec* codec, const unsigned char* src, size_t src_size, unsigned char* dst, size_t dst_cap) {
+	long long freq[256] = {0,};
+	unsigned char lengths[256];
+	uint64_t nbits = 0;
+	int n;
+
+	if (src_size > CODEC_MAX_SIZE || dst_cap < CODEC_HEADER_SIZE + 1 + 256) return -1;
+
+	for (size_t i = 0; i < src_size; i++) freq[src[i]]++;
+	calc_code_lengths(freq, lengths);
+	if (make_canonical_code(lengths, codec->codes) < 0) return -1;
+
+	// 출력 크기를 미리 계산하여 dst에 들어가는지 확인
+	for (int i = 0; i < 256; i++) nbits += (uint64_t)freq[i] * lengths[i];
+	n = pack_code_lengths(lengths, dst + CODEC_HEADER_SIZE);
+	if (CODEC_HEADER_SIZE + n + (nbits + 7) / 8 > dst_cap) return -1;
+
+	for (int i = 0; i < 4; i++) {
+		dst[i] = (uint32_t)src_size >> (8 * i);
+		dst[4 + i] = (uint32_t)nbits >> (8 * i);
+	}
+	encoding_bits(codec->codes, src, src_size, dst + CODEC_HEADER_SIZE + n);
+	return CODEC_HEADER_SIZE + n + (nbits + 7) / 8;
+}
+
+// 압축된 메모리(src, src_size 바이트)의 원본 크기
+// return value : 원본 바이트 수, 형식이 맞지 않는 경우 -1
+long long decompressed_size(const unsigned char* src, size_t src_size) {
+	if (src_size < CODEC_HEADER_SIZE) return -1;
+	return src[0] | (src[1] << 8) | (src[2] << 16) | ((uint32_t)src[3] << 24);
+}
+
+// 압축된 메모리(src, src_size 바이트)를 풀어서 dst(dst_cap 바이트)에 저장
+// return value : dst에 저장한 바이트 수, 형식이 맞지 않거나 dst가 작은 경우 -1
+long long decompress_mem(tCodec* codec, const unsigned char* src, size_t src_size, unsigned char* dst, size_t dst_cap) {
+	unsigned char lengths[256];
+	long long size = decompressed_size(src, src_size);
+	uint64_t nbits;
+	int n;
+
+	if (size < 0 || (uint64_t)size > dst_cap) return -1;
+	nbits = src[4] | (src[5] << 8) | (src[6] << 16) | ((uint64_t)src[7] << 24);
+
+	n = unpack_code_lengths(src + CODEC_HEADER_SIZE, src_size - CODEC_HEADER_SIZE, lengths);
+	if (n < 0 || CODEC_HEADER_SIZE + n + (nbits + 7) / 8 > src_size) return -1;
+	if (make_decode_table(lengths, &codec->dt) < 0) return -1;
+
+	if (decode_with_table(&codec->dt, src + CODEC_HEADER_SIZE + n, (nbits + 7) / 8, dst, size) < 0) return -1;
+	return size;
+}
+
+// 미리 학습한 코드 표 (사전)
+// 코드와 디코딩 테이블을 한번만 만들고, 읽기만 하므로 여러 스레드에서 함께 사용할 수 있음
+struct Dict
+{
+	uint32_t		id;				// 사전 번호 (압축 결과에 저장하여 같은 사전인지 확인)
+	unsigned char	lengths[256];	// 문자별 코드 길이
+	tCode			codes[256];		// 문자별 허프만 코드
+	tDecodeTable	dt;				// 디코딩 테이블
+};
+
+// 코드 길이로부터 사전을 생성 (코드와 디코딩 테이블을 만듦)
+// return value : 사전의 포인터, 코드 길이가 잘못된 경우 NULL
+static tDict* new_dict(uint32_t id, const unsigned char lengths[]) {
+	tDict* dict = malloc(sizeof(tDict));
+
+	if (dict == 0) return 0;
+	dict->id = id;
+	memcpy(dict->lengths, lengths, 256);
+	if (make_canonical_code(dict->lengths, dict->codes) < 0 || make_decode_table(dict->lengths, &dict->dt) < 0) {
+		free(dict);
+		return 0;
+	}
+	return dict;
+}
+
+// 표본의 빈도(ch_freq)로 사전을 학습
+// 표본에 없는 문자도 인코딩할 수 있도록 모든 문자의 빈도에 1을 더하여 코드를 만듦
+// max_len : 코드 길이 제한 (0이면 제한 없음)
+// 사전 번호는 코드 길이의 해시 (FNV-1a)
+// return value : 사전의 포인터, 코드 길이 제한을 만족할 수 없는 경우 NULL
+tDict* train_dict(long long ch_freq[], int max_len) {
+	long long freq[256];
+	unsigned char lengths[256];
+	uint32_t id = 2166136261u;
+
+	for (int i = 0; i < 256; i++) freq[i] = ch_freq[i] + 1;
+	tTree* tree = make_huffman_tree(freq);
+	get_code_lengths(tree, lengths);
+	destroyTree(tree);
+	if (max_len > 0 && max_code_length(lengths) > max_len
+		&& get_limited_code_lengths(freq, max_len, lengths) < 0) return 0;
+
+	for (int i = 0; i < 256; i++) id = (id ^ lengths[i]) * 16777619u;
+	return new_dict(id, lengths);
+}
+
+// 사전 메모리 해제
+void destroy_dict(tDict* dict) {
+	free(dict);
+}
+
+// 사전 번호
+uint32_t dict_id(const tDict* dict) {
+	return dict->id;
+}
+
+// 사전을 파일에 저장
+// DICT_MAGIC, 사전 번호(4), 코드 길이(pack_code_lengths 형식)
+// return value : 0 성공, -1 실패
+int write_dict(FILE* fp, const tDict* dict) {
+	unsigned char buf[2 + 4 + 1 + 256];
+	unsigned char lengths[256];
+
+	memcpy(buf, DICT_MAGIC, 2);
+	for (int i = 0; i < 4; i++) buf[2 + i] = dict->id >> (8 * i);
+	memcpy(lengths, dict->lengths, 256);
+	int n = 6 + pack_code_lengths(lengths, buf + 6);
+	return fwrite(buf, 1, n, fp) == (size_t)n ? 0 : -1;
+}
+
+// 파일로부터 사전을 읽음
+// return value : 사전의 포인터, 형식이 맞지 않는 경우 NULL
+tDict* read_dict(FILE* fp) {
+	unsigned char buf[2 + 4 + 1 + 256];
+	unsigned char lengths[256];
+	size_t n = fread(buf, 1, sizeof(buf), fp);
+
+	if (n < 6 || memcmp(buf, DICT_MAGIC, 2) != 0) return 0;
+	if (unpack_code_lengths(buf + 6, n - 6, lengths) < 0) return 0;
+
+	// 모든 문자에 코드가 있어야 함
+	for (int i = 0; i < 256; i++) {
+		if (lengths[i] == 0) return 0;
+	}
+	return new_dict(buf[2] | (buf[3] << 8) | (buf[4] << 16) | ((uint32_t)buf[5] << 24), lengths);
+}
+
+// size 바이트를 사전(dict)으로 압축했을 때 출력의 최대 크기 (가장 긴 코드로만 인코딩된 경우)
+size_t compress_dict_bound(const tDict* dict, size_t size) {
+	return DICT_HEADER_MAX + (size * dict->dt.max_len + 7) / 8;
+}
+
+// 메모리(src, src_size 바이트)를 사전(dict)의 코드로 압축하여 dst(dst_cap 바이트)에 저장
+// [사전 번호(4), 원본 크기(varint, 7비트씩 하위부터), 비트열] (코드 길이와 비트 수는 저장하지 않음)
+// return value : dst에 저장한 바이트 수, dst가 작은 경우 -1
+long long compress_dict(const tDict* dict, const unsigned char* src, size_t src_size, unsigned char* dst, size_t dst_cap) {
+	uint64_t nbits = 0;
+	size_t n = 4;
+
+	for (size_t i = 0; i < src_size; i++) nbits += dict->lengths[src[i]];
+
+	// 헤더
+	if (dst_cap < DICT_HEADER_MAX) return -1;
+	for (int i = 0; i < 4; i++) dst[i] = dict->id >> (8 * i);
+	for (uint64_t v = src_size; ; v >>= 7) {
+		dst[n++] = (v & 0x7f) | (v >= 0x80 ? 0x80 : 0);
+		if (v < 0x80) break;
+	}
+	if (n + (nbits + 7) / 8 > dst_cap) return -1;
+
+	encoding_bits(dict->codes, src, src_size, dst + n);
+	return n + (nbits + 7) / 8;
+}
+
+// 사전으로 압축된 메모리(src, src_size 바이트)의 원본 크기
+// header_size : 헤더(사전 번호와 원본 크기)의 바이트 수를 저장 (NULL이면 저장하지 않음)
+// return value : 원본 바이트 수, 형식이 맞지 않는 경우 -1
+long long dict_decompressed_size(const unsigned char* src, size_t src_size, size_t* header_size) {
+	uint64_t size = 0;
+
+	for (size_t n = 4; n < src_size && n < DICT_HEADER_MAX; n++) {
+		size |= (uint64_t)(src[n] & 0x7f) << (7 * (n - 4));
+		if ((src[n] & 0x80) == 0) {
+			if (header_size) *header_size = n + 1;
+			return size > (uint64_t)LLONG_MAX ? -1 : (long long)size;
+		}
+	}
+	return -1;
+}
+
+// 사전으로 압축된 메모리(src, src_size 바이트)를 풀어서 dst(dst_cap 바이트)에 저장
+// return value : dst에 저장한 바이트 수, 형식이 맞지 않거나 사전 번호가 다르거나 dst가 작은 경우 -1
+long long decompress_dict(const tDict* dict, const unsigned char* src, size_t src_size, unsigned char* dst, size_t dst_cap) {
+	size_t n;
+	long long size = dict_decompressed_size(src, src_size, &n);
+
+	if (size < 0 || (uint64_t)size > dst_cap) return -1;
+	if ((src[0] | (src[1] << 8) | (src[2] << 16) | ((uint32_t)src[3] << 24)) != dict->id) return -1;
+
+	if (decode_with_table(&dict->dt, src + n, src_size - n, dst, size) < 0) return -1;
+	return size;
+}
+
+// 16비트 심볼 형식의 디코딩 테이블이 한번에 살펴보는(peek) 비트 수
+// 심볼이 많아 코드가 길어지므로 바이트 심볼의 TABLE_BITS보다 큼
+#define WIDE_TABLE_BITS	12
+
+// 디코딩 테이블에서 긴 코드의 앞부분임을 나타내는 비트
+#define WIDE_LONG		0x80000000u
+
+// 16비트 심볼 형식의 디코딩 테이블
+typedef struct
+{
+	uint32_t	table[1 << WIDE_TABLE_BITS];	// (코드 길이 << 16) | 심볼, WIDE_TABLE_BITS보다 긴 코드는 WIDE_LONG | (가장 짧은 길이 << 16)
+	int			max_len;						// 가장 긴 코드의 길이
+	uint64_t	first[MAX_CODE_LEN + 1];		// 길이별 첫번째 코드
+	int			count[MAX_CODE_LEN + 1];		// 길이별 심볼 수
+	int			index[MAX_CODE_LEN + 1];		// 길이별 첫번째 심볼의 sorted 배열 내 위치
+	uint16_t	sorted[WIDE_ALPHABET];			// (코드 길이, 심볼) 순으로 정렬된 심볼
+} tWideTable;
+
+// 빈도 순으로 정렬된 심볼의 코드 길이(A, n개, 빈도가 작은 심볼이 먼저)를 max_len 이하로 줄임
+// max_len보다 긴 코드를 max_len으로 자르고, 넘친 코드 공간만큼 짧은 코드를 한 비트씩 늘린 다음
+// 길이별 심볼 수대로 빈도가 큰 심볼부터 짧은 코드를 다시 배정 (n <= 2^max_len, O(n * max_len))
+static void limit_sorted_lengths(uint64_t A[], int n, int max_len) {
+	uint64_t count[MAX_CODE_LEN + 1] = {0,};
+	uint64_t total = 0;
+
+	for (int i = 0; i < n; i++) count[A[i] < (uint64_t)max_len ? A[i] : (uint64_t)max_len]++;
+	for (int len = 1; len <= max_len; len++) total += count[len] << (max_len - len);
+
+	// 코드 공간(2^max_len)을 넘는 만큼 : 가장 긴 코드 하나를 빼서 더 짧은 코드 하나와 형제로 만듦
+	while (total > ((uint64_t)1 << max_len)) {
+		count[max_len]--;
+		for (int len = max_len - 1; len > 0; len--) {
+			if (count[len]) {
+				count[len]--;
+				count[len + 1] += 2;
+				break;
+			}
+		}
+		total--;
+	}
+
+	int i = n - 1;
+	for (int len = 1; len <= max_len; len++) {
+		for (uint64_t k = 0; k < count[len]; k++) A[i--] = len;
+	}
+}
+
+// 심볼(nsym개)별 빈도(freq)로부터 max_len 이하의 코드 길이를 구하여 lengths에 저장
+// calc_code_lengths 함수와 같은 방법 (힙 정렬 O(n log n) + sorted_code_lengths O(n)), 길면 limit_sorted_lengths로 줄임
+// return value : 0 성공, -1 max_len이 너무 작은 경우 (심볼 수 > 2^max_len)
+static int calc_wide_code_lengths(const long long freq[], int nsym, int max_len, unsigned char lengths[]) {
+	uint64_t* keys = malloc(sizeof(uint64_t) * nsym);
+	uint64_t* A = malloc(sizeof(uint64_t) * nsym);
+	int n = 0, ret = 0;
+
+	memset(lengths, 0, nsym);
+	for (int i = 0; i < nsym; i++) {
+		if (freq[i]) keys[n++] = ((uint64_t)freq[i] << 16) | i;
+	}
+	if (n == 1) lengths[keys[0] & 0xffff] = 1;
+	else if (n > 1 && max_len < 31 && n > (1 << max_len)) ret = -1;
+	else if (n > 1) {
+		sort_keys(keys, n);
+		for (int i = 0; i < n; i++) A[i] = keys[i] >> 16;
+
+		sorted_code_lengths(A, n);
+		if (A[0] > (uint64_t)max_len) limit_sorted_lengths(A, n, max_len);
+		for (int i = 0; i < n; i++) lengths[keys[i] & 0xffff] = A[i];
+	}
+
+	free(keys);
+	free(A);
+	return ret;
+}
+
+// 16비트 심볼(little-endian 2바이트) nsyms개를 코드로 비트열에 이어붙임 (put_codes 함수와 같은 방법)
+static void put_wide_codes(tBitWriter* bw, const tCode codes[], const unsigned char* data, size_t nsyms) {
+	uint64_t acc = bw->acc;
+	int nacc = bw->nacc;
+	size_t pos = bw->pos;
+
+	for (size_t i = 0; i < nsyms; i++) {
+		tCode c = codes[data[2 * i] | (data[2 * i + 1] << 8)];
+		int room = 64 - nacc;
+
+		if (c.len < room) {
+			acc |= c.bits << (room - c.len);
+			nacc += c.len;
+		}
+		else {
+			acc |= c.bits >> (c.len - room);
+			store_be64(bw->buf + pos, acc);
+			pos += 8;
+			nacc = c.len - room;
+			acc = nacc ? c.bits << (64 - nacc) : 0;
+
+			if (pos == bw->cap) {
+				fwrite(bw->buf, 1, pos, bw->fp);
+				bw->nbytes += pos;
+				pos = 0;
+			}
+		}
+	}
+
+	bw->acc = acc;
+	bw->nacc = nacc;
+	bw->pos = pos;
+}
+
+// 메모리(data)에 있는 데이터를 16비트 심볼의 허프만 코드로 인코딩하여 출력 파일(outfp)에 저장
+// max_len : 코드 길이 제한 (0이거나 WIDE_MAX_CODE_LEN보다 크면 WIDE_MAX_CODE_LEN)
+// return value : 출력한 바이트 수, 코드 길이 제한을 만족할 수 없는 경우 -1
+long long encoding_wide(const unsigned char* data, size_t size, int max_len, FILE* outfp) {
+	size_t nsyms = size / 2;
+	long long* freq = calloc(WIDE_ALPHABET, sizeof(long long));
+	unsigned char* lengths = malloc(WIDE_ALPHABET);
+	unsigned char* packed = malloc(3 * WIDE_ALPHABET);
+	tCode* codes = malloc(sizeof(tCode) * WIDE_ALPHABET);
+	unsigned char header[WIDE_HEADER_SIZE];
+	tBitWriter bw;
+	long long ret = -1;
+	int nsym = 0;
+	size_t n = 0;
+
+	if (max_len <= 0 || max_len > WIDE_MAX_CODE_LEN) max_len = WIDE_MAX_CODE_LEN;
+
+	// 심볼별 빈도, 알파벳 크기는 가장 큰 심볼 + 1
+	for (size_t i = 0; i < nsyms; i++) freq[data[2 * i] | (data[2 * i + 1] << 8)]++;
+	for (int i = 0; i < WIDE_ALPHABET; i++) {
+		if (freq[i]) nsym = i + 1;
+	}
+
+	if (calc_wide_code_lengths(freq, nsym, max_len, lengths) == 0 && canonical_codes(lengths, nsym, codes) == 0) {
+		// 코드 길이 : 길이 0인 심볼이 4개 이상 이어지면 (255, 개수 - 1 (2바이트))
+		for (int i = 0; i < nsym; ) {
+			int run = 0;
+			while (i + run < nsym && lengths[i + run] == 0 && run < 65536) run++;
+			if (run >= 4) {
+				packed[n++] = 255;
+				packed[n++] = (run - 1) & 0xff;
+				packed[n++] = (run - 1) >> 8;
+				i += run;
+			}
+			else packed[n++] = lengths[i++];
+		}
+
+		// 헤더 : "HW", 심볼 수(8), 남는 바이트 수(1), 남는 바이트(1), 알파벳 크기(4)
+		memcpy(header, WIDE_MAGIC, 2);
+		store_le64(header + 2, nsyms);
+		header[10] = size & 1;
+		header[11] = size & 1 ? data[size - 1] : 0;
+		for (int i = 0; i < 4; i++) header[12 + i] = (uint32_t)nsym >> (8 * i);
+		fwrite(header, 1, WIDE_HEADER_SIZE, outfp);
+		fwrite(packed, 1, n, outfp);
+
+		bw.fp = outfp;
+		bw.buf = malloc(IO_BUF_SIZE);
+		bw.cap = IO_BUF_SIZE;
+		bw.pos = 0;
+		bw.acc = 0;
+		bw.nacc = 0;
+		bw.nbytes = 0;
+		put_wide_codes(&bw, codes, data, nsyms);
+		ret = WIDE_HEADER_SIZE + n + end_encoding(&bw, 0, 0) + HUF_TAIL_SIZE;
+	}
+
+	free(freq);
+	free(lengths);
+	free(packed);
+	free(codes);
+	return ret;
+}
+
+// 16비트 심볼 형식 파일(in, in_size 바이트)의 원본 크기
+// return value : 원본 바이트 수, 형식이 맞지 않는 경우 -1
+long long wide_decoded_size(const unsigned char* in, size_t in_size) {
+	uint64_t nsyms;
+
+	if (in_size < WIDE_HEADER_SIZE + HUF_TAIL_SIZE || memcmp(in, WIDE_MAGIC, 2) != 0 || in[10] > 1) return -1;
+	nsyms = load_le64(in + 2);
+	if (nsyms > (uint64_t)1 << 61) return -1;
+	return nsyms * 2 + in[10];
+}
+
+// 코드 길이(nsym개 심볼)로부터 16비트 심볼 형식의 디코딩 테이블을 생성 (make_decode_table 함수와 같은 방법)
+// return value : 0 성공, -1 코드 길이가 잘못된 경우
+static int make_wide_table(const unsigned char lengths[], int nsym, tWideTable* wt) {
+	uint64_t next[MAX_CODE_LEN + 1];
+	int pos[MAX_CODE_LEN + 1];
+
+	wt->max_len = canonical_first(lengths, nsym, wt->count, wt->first);
+	if (wt->max_len < 0 || wt->max_len > WIDE_MAX_CODE_LEN) return -1;
+
+	wt->index[0] = 0;
+	for (int len = 1; len <= MAX_CODE_LEN; len++) wt->index[len] = wt->index[len - 1] + wt->count[len - 1];
+	memcpy(pos, wt->index, sizeof(pos));
+	memcpy(next, wt->first, sizeof(next));
+
+	memset(wt->table, 0, sizeof(wt->table));
+	for (int i = 0; i < nsym; i++) {
+		int len = lengths[i];
+		if (len == 0) continue;
+		wt->sorted[pos[len]++] = i;
+
+		uint64_t code = next[len]++;
+		if (len > WIDE_TABLE_BITS) {
+			// 긴 코드 : 앞 WIDE_TABLE_BITS 비트 자리에 그 비트로 시작하는 코드의 가장 짧은 길이를 기록
+			uint32_t* e = &wt->table[code >> (len - WIDE_TABLE_BITS)];
+			if (*e == 0 || ((*e >> 16) & 0xff) > (uint32_t)len) *e = WIDE_LONG | ((uint32_t)len << 16);
+			continue;
+		}
+		// 이 코드로 시작하는 모든 WIDE_TABLE_BITS 비트 패턴이 같은 심볼
+		for (uint32_t k = code << (WIDE_TABLE_BITS - len); k < (code + 1) << (WIDE_TABLE_BITS - len); k++) {
+			wt->table[k] = ((uint32_t)len << 16) | i;
+		}
+	}
+	return 0;
+}
+
+// acc에 들어있는 비트로 심볼 하나를 디코딩 (acc에 max_len 비트 이상 있어야 함)
+// WIDE_TABLE_BITS보다 긴 코드는 테이블에 기록한 길이부터 늘려가며 길이별 코드 범위에 속하는지 확인
+// return value : 심볼, 잘못된 코드인 경우 -1
+static inline int decode_wide(const tWideTable* wt, tMemReader* mr) {
+	uint32_t e = wt->table[mr->acc >> (64 - WIDE_TABLE_BITS)];
+	int len = (e >> 16) & 0xff;
+
+	if (len == 0) return -1;
+	if (e & WIDE_LONG) {
+		for (; len <= wt->max_len; len++) {
+			uint64_t code = mr->acc >> (64 - len);
+			if (code - wt->first[len] < (uint64_t)wt->count[len]) {
+				e = wt->sorted[wt->index[len] + (code - wt->first[len])];
+				break;
+			}
+		}
+		if (len > wt->max_len) return -1;
+	}
+	mr->acc <<= len;
+	mr->nacc -= len;
+	return e & 0xffff;
+}
+
+// 16비트 심볼 형식 파일(in, in_size 바이트)을 디코딩하여 out(out_size 바이트)에 저장
+// return value : 0 성공, -1 형식이 맞지 않는 경우
+int decoding_wide(const unsigned char* in, size_t in_size, unsigned char* out, size_t out_size) {
+	long long size = wide_decoded_size(in, in_size);
+	unsigned char* lengths;
+	tWideTable* wt;
+	tMemReader mr;
+	uint64_t nsyms, nbits;
+	size_t offset = WIDE_HEADER_SIZE, end = in_size - HUF_TAIL_SIZE;
+	int nsym, bad = 0;
+
+	if (size < 0 || (uint64_t)size != out_size) return -1;
+	nsyms = load_le64(in + 2);
+	nsym = in[12] | (in[13] << 8) | (in[14] << 16) | ((uint32_t)in[15] << 24);
+	if (nsym > WIDE_ALPHABET || (nsym == 0 && nsyms > 0)) return -1;
+
+	// 코드 길이
+	lengths = malloc(WIDE_ALPHABET);
+	for (int i = 0; i < nsym && !bad; ) {
+		if (offset >= end) bad = 1;
+		else if (in[offset] == 255) {
+			int run = offset + 3 <= end ? (in[offset + 1] | (in[offset + 2] << 8)) + 1 : 0;
+			if (run == 0 || run > nsym - i) bad = 1;
+			else {
+				memset(lengths + i, 0, run);
+				i += run;
+				offset += 3;
+			}
+		}
+		else if (in[offset] > WIDE_MAX_CODE_LEN) bad = 1;
+		else lengths[i++] = in[offset++];
+	}
+
+	// 비트열은 코드 길이 다음부터 전체 비트 수 앞까지
+	nbits = load_le64(in + end);
+	if (!bad && (offset > end || (nbits + 7) / 8 != end - offset)) bad = 1;
+
+	wt = malloc(sizeof(tWideTable));
+	if (!bad && nsyms > 0 && make_wide_table(lengths, nsym, wt) < 0) bad = 1;
+
+	if (!bad && nsyms > 0) {
+		uint64_t i = 0;
+
+		mem_reader_init(&mr, in + offset, end - offset);
+		// 8바이트씩 채우면 56비트 이상이므로 가장 긴 코드(WIDE_MAX_CODE_LEN) 두개가 들어감
+		while (i < nsyms && !bad) {
+			mem_refill(&mr);
+			for (int k = 0; k < 2 && i < nsyms; k++, i++) {
+				int c = decode_wide(wt, &mr);
+				if (c < 0) {
+					bad = 1;
+					break;
 				}
+				out[2 * i] = c;
+				out[2 * i + 1] = c >> 8;
 			}
 		}
+		if (mem_reader_overrun(&mr)) bad = 1;
 	}
+	if (!bad && in[10]) out[out_size - 1] = in[11];
 
+	free(wt);
+	free(lengths);
+	return bad ? -1 : 0;
 }
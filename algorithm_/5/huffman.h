@@ -1,45 +1,379 @@
 #ifndef HUFFMAN_H
 #define HUFFMAN_H
 
+#include <stdint.h>
+
 #include "node.h"
 
+// 인코딩 파일의 시작 (magic)
+// HUF_MAGIC : 파일 끝의 전체 비트 수가 8바이트 (little-endian)
+// HUF_MAGIC_V1 : 이전 형식, 전체 비트 수가 4바이트 int (256MB 이상의 비트열은 표현할 수 없음, 읽기만 지원)
+#define HUF_MAGIC		"HL"
+#define HUF_MAGIC_V1	"HF"
+#define HUF_TAIL_SIZE	8	// 파일 끝의 전체 비트 수의 크기
+
+// 코드 길이의 최대값 (정수로 표현하는 정규 코드의 최대 비트 수)
+#define MAX_CODE_LEN	64
+
+// 문자별 허프만 코드
+typedef struct
+{
+	uint64_t	bits;	// 코드 (하위 len 비트)
+	int			len;	// 코드의 비트 길이 (0이면 코드 없음)
+} tCode;
+
+// 메모리에 올린 입력 파일
+typedef struct
+{
+	unsigned char	*data;
+	size_t			size;
+	int				mapped;	// 1 : 메모리 매핑(mmap), 0 : 버퍼에 읽어들임
+} tInput;
+
+// 디코딩 결과를 쓰는 출력 파일
+typedef struct
+{
+	FILE			*fp;	// 스트림 출력 (매핑하지 않는 경우)
+	unsigned char	*data;	// 크기를 미리 정하여 메모리 매핑한 출력 (없으면 NULL)
+	size_t			size;	// data의 크기
+	size_t			pos;	// 지금까지 쓴 바이트 수
+	unsigned char	*buf;	// fp로 모아서 쓰는 버퍼
+	size_t			nbuf;	// buf에 저장된 바이트 수
+} tOutput;
+
 ////////////////////////////////////////////////////////////////////////////////
 // 파일에 속한 각 문자(바이트)의 빈도 저장
 // return value : 파일에서 읽은 바이트 수
-int read_chars( FILE *fp, int ch_freq[]);
+long long read_chars( FILE *fp, long long ch_freq[]);
+
+// 메모리(data)에 있는 각 문자(바이트)의 빈도를 ch_freq에 더함
+void count_chars( const unsigned char *data, size_t size, long long ch_freq[]);
+
+// 메모리(data)를 nthreads개의 구간으로 나누어 스레드별로 빈도를 세고 ch_freq에 더함
+void count_chars_parallel( const unsigned char *data, size_t size, long long ch_freq[], int nthreads);
+
+// 입력 파일 전체를 메모리에 올림
+// 일반 파일은 메모리 매핑(mmap), 파이프 등은 버퍼에 모두 읽어들임
+// path가 "-"이면 표준 입력
+// return value : 0 성공, -1 실패
+int open_input( const char *path, tInput *in);
+
+// open_input 함수로 올린 입력을 해제
+void close_input( tInput *in);
+
+// 디코딩 결과를 쓸 출력 파일을 엶
+// 크기(size)를 아는 일반 파일은 그 크기로 만들어 메모리 매핑 (out->data에 직접 씀)
+// path가 "-"이거나 크기를 모르는 경우(size < 0) 버퍼에 모아서 큰 단위로 출력
+// return value : 0 성공, -1 실패
+int open_output( const char *path, long long size, tOutput *out);
+
+// 출력 파일에 n 바이트를 씀
+// return value : 0 성공, -1 실패
+int write_output( tOutput *out, const unsigned char *p, size_t n);
+
+// 버퍼에 모은 출력을 파일로 내보냄 (스트림 출력에서 블록마다 호출)
+// return value : 0 성공, -1 실패
+int flush_output( tOutput *out);
+
+// 남은 버퍼를 출력하고 출력 파일을 닫음
+// return value : 0 성공, -1 쓰기에 실패했거나 매핑한 크기만큼 쓰지 않은 경우
+int close_output( tOutput *out);
+
+// 허프만 트리로부터 (정규) 허프만 코드를 생성
+// get_code_lengths, make_canonical_code 함수 호출
+// return value : 0 성공, -1 코드 길이가 잘못된 경우
+int make_huffman_code( tTree *tree, tCode codes[]);
+
+// 허프만 트리로부터 문자별 코드 길이를 구하여 lengths에 저장
+// 빈도가 0인 문자의 코드 길이는 0
+void get_code_lengths( tTree *tree, unsigned char lengths[]);
+
+// 코드 길이로부터 문자별 정규 허프만 코드(정수 코드 + 비트 길이)를 구하여 codes에 저장
+// 코드가 없는 문자는 길이 0
+// return value : 0 성공, -1 코드 길이가 잘못된 경우
+int make_canonical_code( unsigned char lengths[], tCode codes[]);
+
+// 코드 길이로부터 디코딩용 허프만 트리를 생성 (힙을 사용하지 않음)
+// return value : 트리의 포인터, 코드 길이가 잘못된 경우 NULL
+tTree *make_code_tree( unsigned char lengths[]);
 
-// 파일로부터 문자별 빈도(256개)를 읽어서 ch_freq에 저장
-void get_char_freq( FILE *fp, int ch_freq[]);
+// 코드 길이를 out(257 바이트 이상)에 저장
+// 길이당 비트 수(4 또는 8), 256개의 코드 길이 순서
+// return value : 저장한 바이트 수
+int pack_code_lengths( unsigned char lengths[], unsigned char *out);
 
-// 허프만 트리로부터 허프만 코드를 생성
-// traverse_tree 함수 호출
-void make_huffman_code( tNode *root, char *codes[]);
+// in(size 바이트)에 저장된 코드 길이를 읽어서 lengths에 저장
+// return value : 읽은 바이트 수, 형식이 맞지 않는 경우 -1
+int unpack_code_lengths( const unsigned char *in, size_t size, unsigned char lengths[]);
 
-// 허프만 코드에 대한 메모리 해제
-void free_huffman_code( char *codes[]);
+// 코드 길이(헤더)를 파일에 저장
+// magic 다음에 pack_code_lengths 형식
+void write_code_lengths( FILE *fp, unsigned char lengths[]);
 
-// 허프만 코드를 화면에 출력
-void print_huffman_code( char *codes[]);
+// 파일로부터 코드 길이(헤더)를 읽어서 lengths에 저장
+// 이전 형식(HUF_MAGIC_V1) 파일도 읽음
+// return value : 0 성공, -1 형식이 맞지 않는 경우
+int read_code_lengths( FILE *fp, unsigned char lengths[]);
 
-// 허프만 트리를 생성
-// 1. capacity 256 짜리 빈(empty) 힙 생성 // HEAP *heap = heapCreate( 256);
-// 2. 개별 알파벳에 대한 노드 생성
-// 3. 힙에 삽입 (minheap 구성) // heapInsert( heap, node);
-// 4. 2개의 최소값을 갖는 트리 추출 // tNode *left = heapDelete( heap); tNode *right = heapDelete( heap);
-// 5. 두 트리를 결합 후 새 노드에 추가
-// 6. 새 트리를 힙에 삽입
-// 7. 힙에 한개의 노드가 남을 때까지 반복
-// return value: 트리의 root 노드의 포인터
-tNode *make_huffman_tree( int ch_freq[]);
+// 허프만 코드를 화면에 출력 ('0'/'1' 문자열)
+void print_huffman_code( tCode codes[]);
 
-// 허프만 트리 메모리 해제
-void destroyTree( tNode *root);
+// 허프만 트리를 생성 (두 개의 큐를 이용하는 O(n) 방법)
+// 1. 빈도가 0이 아닌 문자만 leaf 노드로 만들어 빈도 순으로 정렬 (leaf 큐, 4-ary 힙으로 정렬)
+// 2. leaf 큐와 내부 노드 큐의 앞에서 빈도가 가장 작은 노드 2개를 꺼냄 (같으면 leaf 먼저)
+// 3. 두 트리를 결합한 새 노드를 내부 노드 큐의 뒤에 추가 (빈도가 증가하는 순서로 만들어짐)
+// 4. 노드가 한개 남을 때까지 반복
+// 문자가 하나뿐이면 빈도 0인 leaf를 더하여 코드 길이 1, 빈 파일이면 root만 있는 트리
+// 노드는 트리의 노드 풀(1 + 511개)에서 꺼냄
+// return value: 트리의 포인터
+tTree *make_huffman_tree( long long ch_freq[]);
+
+// 허프만 트리 메모리 해제 (노드 풀과 함께 한번에 해제)
+void destroyTree( tTree *tree);
+
+// 디코딩 전용 트리 (flat tree)
+// 내부 노드만 너비 우선(BFS) 순서로 저장한 배열, root는 0번
+// 원소는 (왼쪽, 오른쪽) 자식의 쌍 : FLAT_LEAF 비트가 있으면 leaf이고 하위 8비트가 문자,
+// 아니면 내부 노드의 번호 (0이면 코드에 없는 비트열)
+#define FLAT_LEAF	0x8000
+
+typedef struct
+{
+	uint16_t	(*child)[2];	// 내부 노드별 자식 쌍
+	int			count;			// 내부 노드 수 (root가 leaf인 트리는 0)
+} tFlatTree;
+
+// 허프만 트리로부터 디코딩 전용 트리를 생성 (너비 우선 순서로 번호를 다시 매김)
+// return value : 트리의 포인터, 내부 노드가 너무 많은 경우 NULL
+tFlatTree *make_flat_tree( tTree *tree);
+
+// 디코딩 전용 트리 메모리 해제
+void destroy_flat_tree( tFlatTree *flat);
+
+// 코드 길이가 max_len 이하인 최적의 허프만 코드 길이를 구하여 lengths에 저장 (package-merge)
+// 빈도가 0인 문자의 코드 길이는 0
+// return value : 0 성공, -1 max_len이 너무 작은 경우 (문자 수 > 2^max_len)
+int get_limited_code_lengths( long long ch_freq[], int max_len, unsigned char lengths[]);
+
+// 코드 길이 중 최대값
+int max_code_length( unsigned char lengths[]);
 
 // 입력 텍스트 파일(infp)을 허프만 코드를 이용하여 출력 파일(outfp)로 인코딩
+// 코드 길이 헤더 + 비트열 + 전체 비트 수(HUF_TAIL_SIZE 바이트)
+// return value : 인코딩된 텍스트의 바이트 수 (파일 크기와는 다름)
+long long encoding( tCode codes[], FILE *infp, FILE *outfp);
+
+// 메모리(data)에 있는 텍스트를 허프만 코드를 이용하여 출력 파일(outfp)로 인코딩
+// encoding 함수와 같은 형식으로 출력
 // return value : 인코딩된 텍스트의 바이트 수 (파일 크기와는 다름)
-int encoding( char *codes[], int ch_freq[], FILE *infp, FILE *outfp);
+long long encoding_mem( tCode codes[], const unsigned char *data, size_t size, FILE *outfp);
+
+// 인코딩된 비트열의 최대 바이트 수
+// 허프만 코드의 평균 길이는 8비트 이하이므로 입력 크기 + 8바이트 단위 저장을 위한 여유
+#define ENCODE_BOUND(size)	((((size) + 7) & ~(size_t)7) + 8)
+
+// 동기점 인덱스 : 원본 interval 바이트마다 (원본 위치, 비트열 내 비트 위치)를 기록하여
+// 비트열과 전체 비트 수 사이에 저장 (인덱스를 모르는 디코더는 비트 수만큼만 읽으므로 그대로 디코딩)
+// [동기점] ...  원본 위치(8), 비트 위치(8)
+// [인덱스 끝]   동기점 수(8), 원본 크기(8), SYNC_MAGIC
+#define SYNC_MAGIC				"HSIX"
+#define SYNC_ENTRY_SIZE			16
+#define SYNC_FOOTER_SIZE		20
+#define DEFAULT_SYNC_INTERVAL	(1 << 16)
+
+// 메모리(data)에 있는 텍스트를 encoding_mem 함수와 같은 형식으로 인코딩하면서
+// 원본 interval 바이트마다 동기점을 기록하여 인덱스를 저장
+// return value : 인코딩된 텍스트와 인덱스의 바이트 수 (파일 크기와는 다름)
+long long encoding_indexed( tCode codes[], const unsigned char *data, size_t size, size_t interval, FILE *outfp);
+
+// 동기점 인덱스가 있는 허프만 형식 파일(in, in_size 바이트)의 원본 크기
+// return value : 원본 바이트 수, 형식이 맞지 않거나 인덱스가 없는 경우 -1
+long long indexed_decoded_size( const unsigned char *in, size_t in_size);
+
+// 동기점 인덱스가 있는 허프만 형식 파일(in, in_size 바이트, 메모리에 올린 파일 전체)에서
+// 원본의 offset 바이트부터 length 바이트를 디코딩하여 out에 저장
+// offset 이전의 마지막 동기점부터 디코딩하므로 파일 크기와 관계없이 동기점 간격 + length 만큼만 읽음
+// return value : 디코딩한 바이트 수 (원본의 끝에서 잘림), 형식이 맞지 않거나 인덱스가 없는 경우 -1
+long long decoding_range( const unsigned char *in, size_t in_size, uint64_t offset, size_t length, unsigned char *out);
+
+// 메모리(data)에 있는 텍스트를 허프만 코드를 이용하여 비트열로 인코딩하여 out에 저장
+// 헤더와 전체 비트 수는 저장하지 않음
+// out의 크기는 ENCODE_BOUND(size) 이상이어야 함
+// return value : 비트열의 비트 수
+uint64_t encoding_bits( const tCode codes[], const unsigned char *data, size_t size, unsigned char *out);
+
+// 4-stream 인코딩의 비트열 수
+#define NUM_STREAMS			4
+// 4-stream 인코딩의 점프 테이블 크기 (마지막을 제외한 비트열들의 바이트 수)
+#define STREAMS_JUMP_SIZE	(4 * (NUM_STREAMS - 1))
+// 4-stream 인코딩 결과의 최대 바이트 수
+// 비트열 하나는 문자당 8비트를 넘을 수 있지만 전체는 ENCODE_BOUND(size) 이하, 비트열마다 마지막 바이트를 0으로 채움
+#define STREAMS_BOUND(size)	(STREAMS_JUMP_SIZE + ENCODE_BOUND(size) + NUM_STREAMS)
+
+// 메모리(data)에 있는 텍스트를 NUM_STREAMS개의 비트열로 나누어 인코딩하여 out에 저장
+// i번째 문자는 i % NUM_STREAMS번째 비트열에 저장
+// [점프 테이블] [비트열 0] ... [비트열 NUM_STREAMS-1]
+// out의 크기는 STREAMS_BOUND(size) 이상이어야 함
+// return value : out에 저장한 바이트 수
+size_t encoding_streams( tCode codes[], const unsigned char *data, size_t size, unsigned char *out);
+
+// order-1 문맥 모델 형식
+// [헤더]      "H1", 원본 크기(8), 클러스터 수(2), 문맥(앞 문자)별 클러스터 번호(256)
+// [코드 길이] 클러스터별 pack_code_lengths 형식 ...
+// [비트열]    각 문자를 앞 문자가 속한 클러스터의 정규 허프만 코드로 인코딩 (첫 문자의 문맥은 0)
+// 정수는 little-endian
+#define ORDER1_MAGIC		"H1"
+#define ORDER1_HEADER_SIZE	(2 + 8 + 2 + 256)
+
+// 문맥을 합칠지 판단하는 코드 길이 표 하나의 비트 수 (nibble 형식)
+#define ORDER1_TABLE_BITS	((1 + 128) * 8)
+
+// 메모리(data)에 있는 텍스트를 order-1 문맥 모델로 인코딩하여 출력 파일(outfp)에 저장
+// 빈도 분포가 비슷한 문맥끼리 묶은 클러스터마다 허프만 코드를 만듦 (헤더 크기를 줄임)
+// max_len : 코드 길이 제한 (0이면 제한 없음)
+// return value : 출력한 바이트 수, 코드 길이 제한을 만족할 수 없는 경우 -1
+long long encoding_order1( const unsigned char *data, size_t size, int max_len, FILE *outfp);
+
+// order-1 형식 파일(in, in_size 바이트)의 원본 크기
+// return value : 원본 바이트 수, 형식이 맞지 않는 경우 -1
+long long order1_decoded_size( const unsigned char *in, size_t in_size);
+
+// order-1 형식 파일(in, in_size 바이트)을 디코딩하여 out(out_size 바이트)에 저장
+// 앞 문자(문맥)가 속한 클러스터의 룩업 테이블로 각 문자를 디코딩
+// max_len : 허용하는 코드 길이의 최대값
+// return value : 0 성공, -1 형식이 맞지 않는 경우
+int decoding_order1( const unsigned char *in, size_t in_size, unsigned char *out, size_t out_size, int max_len);
+
+// 16비트 심볼 형식 : 입력을 2바이트(little-endian) 단위의 심볼로 보고 최대 65536개 심볼의 허프만 코드로 인코딩
+// (토큰 번호나 16비트 센서 값처럼 바이트 단위로는 분포를 나타낼 수 없는 데이터)
+// [헤더]      "HW", 심볼 수(8), 남는 바이트 수(1, 원본 크기가 홀수이면 1), 남는 바이트(1), 알파벳 크기(4, 가장 큰 심볼 + 1)
+// [코드 길이] 알파벳 크기만큼의 심볼별 코드 길이 (0 ~ WIDE_MAX_CODE_LEN), 255이면 다음 2바이트(n)로 길이 0인 심볼 n+1개
+// [비트열]    심볼별 정규 허프만 코드
+// [파일 끝]   전체 비트 수(HUF_TAIL_SIZE 바이트)
+// 정수는 little-endian
+#define WIDE_MAGIC			"HW"
+#define WIDE_HEADER_SIZE	16
+#define WIDE_ALPHABET		65536	// 알파벳 크기의 최대값
+#define WIDE_MAX_CODE_LEN	24		// 코드 길이의 최대값 (디코더가 8바이트를 채울 때마다 두 심볼을 디코딩)
+
+// 메모리(data)에 있는 데이터를 16비트 심볼의 허프만 코드로 인코딩하여 출력 파일(outfp)에 저장
+// 코드 길이는 트리 없이 정렬한 빈도로 구함 (심볼 수 n에 대해 O(n log n))
+// max_len : 코드 길이 제한 (0이거나 WIDE_MAX_CODE_LEN보다 크면 WIDE_MAX_CODE_LEN)
+// return value : 출력한 바이트 수, 코드 길이 제한을 만족할 수 없는 경우 -1
+long long encoding_wide( const unsigned char *data, size_t size, int max_len, FILE *outfp);
+
+// 16비트 심볼 형식 파일(in, in_size 바이트)의 원본 크기
+// return value : 원본 바이트 수, 형식이 맞지 않는 경우 -1
+long long wide_decoded_size( const unsigned char *in, size_t in_size);
+
+// 16비트 심볼 형식 파일(in, in_size 바이트)을 디코딩하여 out(out_size 바이트)에 저장
+// 룩업 테이블로 짧은 코드를 바로 찾고, 긴 코드는 길이별 코드 범위로 찾음
+// return value : 0 성공, -1 형식이 맞지 않는 경우
+int decoding_wide( const unsigned char *in, size_t in_size, unsigned char *out, size_t out_size);
+
+// 입력 파일(infp)을 허프만 트리를 이용하여 출력 파일(out)로 디코딩 (버퍼에 모아서 출력)
+// 비트열은 infp의 현재 위치(헤더 다음)부터 시작
+void decoding( tTree *tree, FILE *infp, tOutput *out);
+
+// 입력 파일(infp)을 디코딩 전용 트리를 이용하여 출력 파일(out)로 디코딩
+// decoding 함수와 같은 결과를 출력
+void decoding_flat( tFlatTree *flat, FILE *infp, tOutput *out);
+
+// 입력 파일(infp)을 코드 길이로부터 만든 룩업 테이블을 이용하여 출력 파일(out)로 디코딩
+// 여러 비트를 한번에 살펴보고 심볼과 코드 길이를 얻음 (긴 코드는 길이별 코드 범위로 탐색)
+// decoding 함수와 같은 결과를 출력
+// return value : 0 성공, -1 코드 길이가 잘못되었거나 파일 끝의 비트 수가 맞지 않는 경우
+int decoding_table( unsigned char lengths[], FILE *infp, tOutput *out);
+
+// 메모리에 있는 비트열(in, in_size 바이트)을 코드 길이로부터 만든 룩업 테이블을 이용하여
+// out_size개의 문자로 디코딩하여 out에 저장
+// return value : 0 성공, -1 코드 길이나 비트열이 잘못된 경우
+int decoding_mem( unsigned char lengths[], const unsigned char *in, size_t in_size, unsigned char *out, size_t out_size);
+
+// NUM_STREAMS개의 비트열로 나누어 인코딩된 데이터(in, in_size 바이트)를 out_size개의 문자로 디코딩
+// 비트열마다 독립적인 비트 입력을 두고 한 반복에서 함께 진행
+// return value : 0 성공, -1 코드 길이나 비트열이 잘못된 경우
+int decoding_streams( unsigned char lengths[], const unsigned char *in, size_t in_size, unsigned char *out, size_t out_size);
+
+////////////////////////////////////////////////////////////////////////////////
+// 버퍼 API : FILE 없이 메모리에서 메모리로 압축/해제
+// 압축 결과는 [원본 크기(4), 비트 수(4), 코드 길이(pack_code_lengths 형식), 비트열]
+// 상태(tCodec)를 재사용하면 호출마다 메모리를 할당하지 않음 (스레드마다 하나씩 사용)
+
+#define CODEC_HEADER_SIZE	8				// 원본 크기와 비트 수
+#define CODEC_MAX_SIZE		((size_t)1 << 28)	// 비트 수가 32비트로 표현되는 크기
+
+typedef struct Codec tCodec;
+
+// 버퍼 API의 상태를 생성
+// return value : 상태의 포인터, 메모리가 부족한 경우 NULL
+tCodec *create_codec( void);
+
+// 버퍼 API의 상태 메모리 해제
+void destroy_codec( tCodec *codec);
+
+// size 바이트를 압축했을 때 출력의 최대 크기
+size_t compress_bound( size_t size);
+
+// 메모리(src, src_size 바이트)를 압축하여 dst(dst_cap 바이트)에 저장
+// return value : dst에 저장한 바이트 수, dst가 작거나 src가 CODEC_MAX_SIZE보다 크거나 코드를 만들 수 없는 경우 -1
+long long compress_mem( tCodec *codec, const unsigned char *src, size_t src_size, unsigned char *dst, size_t dst_cap);
+
+// 압축된 메모리(src, src_size 바이트)의 원본 크기
+// return value : 원본 바이트 수, 형식이 맞지 않는 경우 -1
+long long decompressed_size( const unsigned char *src, size_t src_size);
+
+// 압축된 메모리(src, src_size 바이트)를 풀어서 dst(dst_cap 바이트)에 저장
+// return value : dst에 저장한 바이트 수, 형식이 맞지 않거나 dst가 작은 경우 -1
+long long decompress_mem( tCodec *codec, const unsigned char *src, size_t src_size, unsigned char *dst, size_t dst_cap);
+
+////////////////////////////////////////////////////////////////////////////////
+// 사전 : 표본으로 미리 학습한 코드 표
+// 작은 메시지마다 코드 길이 헤더를 저장하지 않고 사전 번호만 저장 (메시지마다 트리를 만들지 않음)
+// 사전 파일 : DICT_MAGIC, 사전 번호(4), 코드 길이(pack_code_lengths 형식)
+// 사전으로 압축한 파일 : DICT_FILE_MAGIC 다음에 compress_dict 형식
+
+#define DICT_MAGIC		"HT"
+#define DICT_FILE_MAGIC	"HD"
+#define DICT_HEADER_MAX	(4 + 10)	// 사전 번호와 원본 크기(varint)의 최대 바이트 수
+
+typedef struct Dict tDict;
+
+// 표본의 빈도(ch_freq)로 사전을 학습
+// 표본에 없는 문자도 인코딩할 수 있도록 모든 문자의 빈도에 1을 더하여 코드를 만듦
+// max_len : 코드 길이 제한 (0이면 제한 없음)
+// return value : 사전의 포인터, 코드 길이 제한을 만족할 수 없는 경우 NULL
+tDict *train_dict( long long ch_freq[], int max_len);
+
+// 사전 메모리 해제
+void destroy_dict( tDict *dict);
+
+// 사전 번호
+uint32_t dict_id( const tDict *dict);
+
+// 사전을 파일에 저장
+// return value : 0 성공, -1 실패
+int write_dict( FILE *fp, const tDict *dict);
+
+// 파일로부터 사전을 읽음
+// return value : 사전의 포인터, 형식이 맞지 않는 경우 NULL
+tDict *read_dict( FILE *fp);
+
+// size 바이트를 사전(dict)으로 압축했을 때 출력의 최대 크기
+size_t compress_dict_bound( const tDict *dict, size_t size);
+
+// 메모리(src, src_size 바이트)를 사전(dict)의 코드로 압축하여 dst(dst_cap 바이트)에 저장
+// [사전 번호(4), 원본 크기(varint), 비트열]
+// return value : dst에 저장한 바이트 수, dst가 작은 경우 -1
+long long compress_dict( const tDict *dict, const unsigned char *src, size_t src_size, unsigned char *dst, size_t dst_cap);
+
+// 사전으로 압축된 메모리(src, src_size 바이트)의 원본 크기
+// header_size : 헤더(사전 번호와 원본 크기)의 바이트 수를 저장 (NULL이면 저장하지 않음)
+// return value : 원본 바이트 수, 형식이 맞지 않는 경우 -1
+long long dict_decompressed_size( const unsigned char *src, size_t src_size, size_t *header_size);
 
-// 입력 파일(infp)을 허프만 트리를 이용하여 텍스트 파일(outfp)로 디코딩
-void decoding( tNode *root, FILE *infp, FILE *outfp);
+// 사전으로 압축된 메모리(src, src_size 바이트)를 풀어서 dst(dst_cap 바이트)에 저장
+// return value : dst에 저장한 바이트 수, 형식이 맞지 않거나 사전 번호가 다르거나 dst가 작은 경우 -1
+long long decompress_dict( const tDict *dict, const unsigned char *src, size_t src_size, unsigned char *dst, size_t dst_cap);
 
 #endif
@@ -0,0 +1,1108 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#include <sys/resource.h>
+#include <sys/wait.h>
+
+#include "heap.h"
+#include "huffman.h"
+#include "parallel.h"
+#include "block.h"
+#include "crc32c.h"
+#include "lz77.h"
+
+////////////////////////////////////////////////////////////////////////////////
+// 현재 시각 (초)
+static double now( void)
+{
+	struct timespec ts;
+	
+	clock_gettime( CLOCK_MONOTONIC, &ts);
+	return ts.tv_sec + ts.tv_nsec * 1e-9;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// 텍스트와 비슷한 분포의 임의 데이터 생성 (영문자 위주, 공백과 줄바꿈 포함)
+static void make_random_text( unsigned char *data, size_t size)
+{
+	static const char alphabet[] = "eeeeeeetttttaaaaoooiiinnnsssrrhhlldcumfpgwybvkxjqz     \n";
+	unsigned int x = 12345;
+	size_t i;
+	
+	for (i = 0; i < size; i++)
+	{
+		x = x * 1103515245 + 12345;
+		data[i] = alphabet[(x >> 16) % (sizeof(alphabet) - 1)];
+	}
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// 빈도 계산의 스레드 수별 처리량 (GB/s)
+// 스레드 수마다 3번 실행하여 가장 빠른 시간을 사용
+static void bench_hist( tInput *input)
+{
+	int max_threads = default_threads();
+	int nthreads, rep;
+	long long base_freq[256] = {0,};
+	
+	count_chars( input->data, input->size, base_freq);
+	
+	printf( "# histogram, %zu bytes\n", input->size);
+	printf( "# threads\tGB/s\n");
+	for (nthreads = 1; ; nthreads *= 2)
+	{
+		double best = 0;
+		
+		if (nthreads > max_threads) nthreads = max_threads;
+		
+		for (rep = 0; rep < 3; rep++)
+		{
+			long long ch_freq[256] = {0,};
+			double t = now();
+			
+			count_chars_parallel( input->data, input->size, ch_freq, nthreads);
+			t = now() - t;
+			
+			if (memcmp( ch_freq, base_freq, sizeof(ch_freq)) != 0)
+			{
+				fprintf( stderr, "Error: histogram mismatch with %d threads\n", nthreads);
+				exit( 1);
+			}
+			if (best == 0 || t < best) best = t;
+		}
+		printf( "%d\t%.2f\n", nthreads, input->size / best / 1e9);
+		
+		if (nthreads >= max_threads) break;
+	}
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// 64비트 의사 난수 (xorshift)
+static unsigned long long next_random( unsigned long long *x)
+{
+	*x ^= *x << 13;
+	*x ^= *x >> 7;
+	*x ^= *x << 17;
+	return *x;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// 힙의 자식 수(arity)별 처리량 (백만 연산/초)
+// 원소 size개로 heapify한 뒤 ops번 연산 : 최소값 제거 후 더 큰 키로 다시 삽입 (hold 모델),
+// 4번에 한번은 임의의 원소를 decrease-key
+static void bench_heap( long long ops)
+{
+	static const int arities[] = { 2, 4, 8 };
+	int size = ops / 4 < (1 << 22) ? (int)(ops / 4) : (1 << 22);
+	tHeapItem *items;
+	int a, i;
+	
+	if (size < 1) size = 1;
+	items = (tHeapItem *)malloc( sizeof(tHeapItem) * size);
+	
+	printf( "# heap, %d elements, %lld operations\n", size, ops);
+	printf( "# arity\tMops/s\n");
+	for (a = 0; a < 3; a++)
+	{
+		HEAP *heap = heapCreate( size, arities[a], NULL, NULL);
+		unsigned long long x = 88172645463325252ULL;
+		long long key, n;
+		double t;
+		
+		for (i = 0; i < size; i++)
+		{
+			items[i].key = next_random( &x) % 1000000000;
+			items[i].id = i;
+		}
+		
+		t = now();
+		heapify( heap, items, size);
+		for (n = 0; n < ops; n++)
+		{
+			if ((n & 3) == 3)
+			{
+				int id = next_random( &x) % size;
+				long long k;
+				
+				heapPeek( heap, &k);
+				heapDecreaseKey( heap, id, k);
+			}
+			else
+			{
+				int id = heapDelete( heap, &key);
+				
+				heapInsert( heap, key + next_random( &x) % 1000000, id);
+			}
+		}
+		t = now() - t;
+		
+		printf( "%d\t%.2f\n", arities[a], ops / t / 1e6);
+		heapDestroy( heap);
+	}
+	
+	free( items);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// 기하 분포의 임의 데이터 생성
+// 문자 i가 나올 확률은 (1-q) q^i (q = num/den, 255에서 잘림), q가 클수록 깊은 트리
+static void make_geometric( unsigned char *data, size_t size, int num, int den)
+{
+	unsigned long long x = 88172645463325252ULL;
+	size_t i;
+	
+	for (i = 0; i < size; i++)
+	{
+		int c = 0;
+		
+		while (c < 255 && (int)(next_random( &x) % den) < num) c++;
+		data[i] = c;
+	}
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// "aaa" 다음에 임의 바이트 하나를 반복한 데이터 생성
+// 긴 코드의 문자가 모두 4-stream 인코딩의 마지막 비트열에 들어가므로 비트열 하나가 문자당 8비트를 넘음
+static void make_strided( unsigned char *data, size_t size)
+{
+	unsigned long long x = 88172645463325252ULL;
+	size_t i;
+	
+	for (i = 0; i < size; i++)
+	{
+		data[i] = i % 4 == 3 ? next_random( &x) & 0xff : 'a';
+	}
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// 트리 디코더(노드 풀)와 디코딩 전용 트리(너비 우선 배열) 디코더의 처리량 (MB/s)
+// 트리 깊이가 다른 여러 분포의 데이터를 인코딩한 뒤 각각 3번 디코딩하여 가장 빠른 시간을 사용
+static void bench_tree( size_t size)
+{
+	static const struct { const char *name; int num, den; } sets[] = {
+		{ "uniform", 0, 0 }, { "text", 0, 0 }, { "geo-1/2", 1, 2 }, { "geo-3/4", 3, 4 }, { "geo-15/16", 15, 16 },
+	};
+	unsigned char *data = malloc( size);
+	int s, rep, m;
+	
+	printf( "# tree decoding, %zu bytes\n", size);
+	printf( "# data\tdepth\ttree MB/s\tflat MB/s\n");
+	for (s = 0; s < (int)(sizeof(sets) / sizeof(sets[0])); s++)
+	{
+		long long ch_freq[256] = {0,};
+		unsigned char lengths[256];
+		tCode codes[256];
+		double best[2] = { 0, 0 };
+		FILE *fp = tmpfile();
+		size_t i;
+		
+		if (s == 0)
+		{
+			unsigned long long x = 88172645463325252ULL;
+			for (i = 0; i < size; i++) data[i] = next_random( &x) & 0xff;
+		}
+		else if (s == 1) make_random_text( data, size);
+		else make_geometric( data, size, sets[s].num, sets[s].den);
+		
+		count_chars( data, size, ch_freq);
+		tTree *tree = make_huffman_tree( ch_freq);
+		get_code_lengths( tree, lengths);
+		destroyTree( tree);
+		make_canonical_code( lengths, codes);
+		encoding_mem( codes, data, size, fp);
+		
+		for (m = 0; m < 2; m++)
+		{
+			for (rep = 0; rep < 3; rep++)
+			{
+				tOutput out;
+				double t;
+				
+				rewind( fp);
+				read_code_lengths( fp, lengths);
+				tree = make_code_tree( lengths);
+				tFlatTree *flat = make_flat_tree( tree);
+				open_output( "/dev/null", -1, &out);
+				
+				t = now();
+				if (m == 0) decoding( tree, fp, &out);
+				else decoding_flat( flat, fp, &out);
+				t = now() - t;
+				
+				if (out.pos != size)
+				{
+					fprintf( stderr, "Error: %s decoded %zu of %zu bytes\n", sets[s].name, out.pos, size);
+					exit( 1);
+				}
+				close_output( &out);
+				destroy_flat_tree( flat);
+				destroyTree( tree);
+				if (best[m] == 0 || t < best[m]) best[m] = t;
+			}
+		}
+		printf( "%s\t%d\t%.1f\t%.1f\n", sets[s].name, max_code_length( lengths), size / best[0] / 1e6, size / best[1] / 1e6);
+		fclose( fp);
+	}
+	
+	free( data);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// 버퍼 API의 메시지 크기별 처리량 (MB/s, 메시지/초)
+// 상태(tCodec)와 버퍼를 하나씩만 만들어 재사용하고, 크기마다 전체 total 바이트만큼 반복
+static void bench_msg( size_t total)
+{
+	static const size_t sizes[] = { 1 << 10, 4 << 10, 16 << 10, 64 << 10, 256 << 10, 1 << 20 };
+	size_t max_size = sizes[sizeof(sizes) / sizeof(sizes[0]) - 1];
+	unsigned char *data = malloc( max_size);
+	unsigned char *comp = malloc( compress_bound( max_size));
+	unsigned char *back = malloc( max_size);
+	tCodec *codec = create_codec();
+	int s;
+	
+	make_random_text( data, max_size);
+	
+	printf( "# buffer API, %zu bytes per size\n", total);
+	printf( "# size\tratio\tcomp MB/s\tcomp msg/s\tdecomp MB/s\tdecomp msg/s\n");
+	for (s = 0; s < (int)(sizeof(sizes) / sizeof(sizes[0])); s++)
+	{
+		size_t size = sizes[s];
+		long long reps = total / size, r;
+		long long comp_size = 0;
+		double tc, td;
+		
+		tc = now();
+		for (r = 0; r < reps; r++)
+		{
+			comp_size = compress_mem( codec, data, size, comp, compress_bound( size));
+		}
+		tc = now() - tc;
+		
+		td = now();
+		for (r = 0; r < reps; r++)
+		{
+			if (decompress_mem( codec, comp, comp_size, back, size) != (long long)size)
+			{
+				fprintf( stderr, "Error: cannot decompress %zu bytes\n", size);
+				exit( 1);
+			}
+		}
+		td = now() - td;
+		
+		if (memcmp( data, back, size) != 0)
+		{
+			fprintf( stderr, "Error: round trip mismatch at %zu bytes\n", size);
+			exit( 1);
+		}
+		printf( "%zu\t%.3f\t%.1f\t%.0f\t%.1f\t%.0f\n", size, (double)comp_size / size,
+			reps * size / tc / 1e6, reps / tc, reps * size / td / 1e6, reps / td);
+	}
+	
+	destroy_codec( codec);
+	free( back);
+	free( comp);
+	free( data);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// CRC32C의 처리량 (crc32 명령어, slicing-by-8)과 블록 형식에서 CRC32C를 저장/확인하는 비용
+// 블록 형식은 스레드 하나로 메모리에서 인코딩/디코딩 (MB/s)
+static void bench_crc( size_t size)
+{
+	unsigned char *data = malloc( size);
+	unsigned char *back = malloc( size);
+	uint32_t crc[2];
+	double t, best;
+	int k, rep;
+	
+	make_random_text( data, size);
+	
+	printf( "# CRC32C, %zu bytes (crc32 instruction %s)\n", size, crc32c_hw() ? "available" : "not available");
+	printf( "# method\tMB/s\n");
+	for (k = 0; k < 2; k++)
+	{
+		for (best = 0, rep = 0; rep < 3; rep++)
+		{
+			t = now();
+			crc[k] = k == 0 ? crc32c( 0, data, size) : crc32c_sw( 0, data, size);
+			t = now() - t;
+			if (best == 0 || t < best) best = t;
+		}
+		printf( "%s\t%.1f\n", k == 0 ? "crc32c" : "slicing-by-8", size / best / 1e6);
+	}
+	if (crc[0] != crc[1])
+	{
+		fprintf( stderr, "Error: CRC32C mismatch %08x %08x\n", crc[0], crc[1]);
+		exit( 1);
+	}
+	
+	printf( "# block format, 1 thread\n");
+	printf( "# checksum\tsize\tencode MB/s\tdecode MB/s\n");
+	for (k = 0; k < 2; k++)
+	{
+		FILE *fp = NULL;
+		double te = 0, td = 0;
+		long long encoded = -1;
+		
+		for (rep = 0; rep < 3; rep++)
+		{
+			if (fp) fclose( fp);
+			fp = tmpfile();
+			t = now();
+			encoded = block_encoding( data, size, fp, DEFAULT_BLOCK_SIZE, 0, 1 | (k ? BLOCK_CHECKSUM : 0), 1);
+			t = now() - t;
+			if (te == 0 || t < te) te = t;
+		}
+		
+		unsigned char *enc = malloc( encoded > 0 ? encoded : 1);
+		rewind( fp);
+		if (encoded < 0 || fread( enc, 1, encoded, fp) != (size_t)encoded)
+		{
+			fprintf( stderr, "Error: cannot encode blocks\n");
+			exit( 1);
+		}
+		fclose( fp);
+		
+		for (rep = 0; rep < 3; rep++)
+		{
+			// 출력 버퍼를 매핑한 출력 파일처럼 사용
+			tOutput out = { NULL, back, size, 0, NULL, 0 };
+			
+			t = now();
+			if (block_decoding( enc, encoded, &out, MAX_CODE_LEN, 1) < 0 || memcmp( data, back, size) != 0)
+			{
+				fprintf( stderr, "Error: block round trip mismatch\n");
+				exit( 1);
+			}
+			t = now() - t;
+			if (td == 0 || t < td) td = t;
+		}
+		printf( "%s\t%lld\t%.1f\t%.1f\n", k ? "crc32c" : "none", encoded, size / te / 1e6, size / td / 1e6);
+		free( enc);
+	}
+	
+	free( back);
+	free( data);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// 큰 파일 테스트 데이터의 chunk번째 조각 (LARGE_CHUNK 바이트)
+// 임의 텍스트의 일부 바이트를 조각 번호로 바꾸어 조각마다 다르게 만듦 (다시 만들어 검사에 사용)
+#define LARGE_CHUNK	((size_t)64 << 20)
+static void make_large_chunk( unsigned char *buf, const unsigned char *text, long long chunk)
+{
+	size_t i;
+	
+	memcpy( buf, text, LARGE_CHUNK);
+	for (i = chunk % 4093; i < LARGE_CHUNK; i += 4093) buf[i] = 'A' + chunk % 26;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// 디코딩한 파일(path)이 size 바이트의 테스트 데이터와 같은지 조각 단위로 비교
+// return value : 1 같음, 0 다름
+static int check_large_file( const char *path, long long size, const unsigned char *text, unsigned char *expect, unsigned char *buf)
+{
+	FILE *fp = fopen( path, "rb");
+	long long pos;
+	int same = fp != NULL;
+	
+	for (pos = 0; same && pos < size; pos += LARGE_CHUNK)
+	{
+		size_t n = size - pos < (long long)LARGE_CHUNK ? (size_t)(size - pos) : LARGE_CHUNK;
+		
+		make_large_chunk( expect, text, pos / LARGE_CHUNK);
+		if (fread( buf, 1, n, fp) != n || memcmp( buf, expect, n) != 0) same = 0;
+	}
+	if (same && fgetc( fp) != EOF) same = 0;
+	if (fp) fclose( fp);
+	return same;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// size 바이트의 큰 파일을 허프만 형식과 블록 형식으로 왕복(인코딩 후 디코딩)하여 비교하고 처리량 (MB/s)
+// 입력 파일은 메모리 매핑으로 인코딩하고, 디코딩은 파일 입출력으로 조각 단위로 비교
+// 임시 파일은 dir에 만들고 지움 (디스크에 원본 크기의 2배 정도가 필요)
+static int bench_large( long long size, const char *dir)
+{
+	char in_path[4096], enc_path[4096], dec_path[4096];
+	unsigned char *text = malloc( LARGE_CHUNK);
+	unsigned char *expect = malloc( LARGE_CHUNK);
+	unsigned char *buf = malloc( LARGE_CHUNK);
+	int nthreads = default_threads();
+	int m, ok = 1;
+	long long pos;
+	FILE *fp;
+	
+	snprintf( in_path, sizeof(in_path), "%s/huffman_large.txt", dir);
+	snprintf( enc_path, sizeof(enc_path), "%s/huffman_large.huf", dir);
+	snprintf( dec_path, sizeof(dec_path), "%s/huffman_large.out", dir);
+	make_random_text( text, LARGE_CHUNK);
+	
+	// 테스트 데이터
+	fp = fopen( in_path, "wb");
+	if (fp == NULL)
+	{
+		fprintf( stderr, "Error: cannot open file [%s]\n", in_path);
+		return 1;
+	}
+	for (pos = 0; pos < size; pos += LARGE_CHUNK)
+	{
+		size_t n = size - pos < (long long)LARGE_CHUNK ? (size_t)(size - pos) : LARGE_CHUNK;
+		
+		make_large_chunk( buf, text, pos / LARGE_CHUNK);
+		if (fwrite( buf, 1, n, fp) != n) ok = 0;
+	}
+	if (fclose( fp) != 0 || !ok)
+	{
+		fprintf( stderr, "Error: cannot write file [%s]\n", in_path);
+		remove( in_path);
+		return 1;
+	}
+	
+	printf( "# large file round trip, %lld bytes\n", size);
+	printf( "# format\tencoded bytes\tencode MB/s\tdecode MB/s\tcheck\n");
+	for (m = 0; m < 2 && ok; m++)
+	{
+		long long encoded;
+		int ret;
+		double te, td;
+		tInput input;
+		tOutput out;
+		
+		// 인코딩 (입력 파일을 메모리 매핑)
+		te = now();
+		if (open_input( in_path, &input) < 0 || (fp = fopen( enc_path, "wb")) == NULL)
+		{
+			fprintf( stderr, "Error: cannot open file [%s]\n", in_path);
+			ok = 0;
+			break;
+		}
+		if (m == 0)
+		{
+			long long ch_freq[256] = {0,};
+			unsigned char lengths[256];
+			tCode codes[256];
+			
+			count_chars_parallel( input.data, input.size, ch_freq, nthreads);
+			tTree *tree = make_huffman_tree( ch_freq);
+			get_code_lengths( tree, lengths);
+			destroyTree( tree);
+			make_canonical_code( lengths, codes);
+			encoded = encoding_mem( codes, input.data, input.size, fp);
+		}
+		else encoded = block_encoding( input.data, input.size, fp, DEFAULT_BLOCK_SIZE, 0, NUM_STREAMS, nthreads);
+		if (fclose( fp) != 0) encoded = -1;
+		close_input( &input);
+		te = now() - te;
+		
+		// 디코딩 (허프만 형식은 파일에서 읽어서 버퍼 출력, 블록 형식은 매핑한 출력에 직접)
+		td = now();
+		if (m == 0)
+		{
+			unsigned char lengths[256];
+			
+			fp = fopen( enc_path, "rb");
+			ret = fp && read_code_lengths( fp, lengths) == 0 && open_output( dec_path, -1, &out) == 0 ? 0 : -1;
+			if (ret == 0)
+			{
+				ret = decoding_table( lengths, fp, &out);
+				if (close_output( &out) < 0) ret = -1;
+			}
+			if (fp) fclose( fp);
+		}
+		else
+		{
+			ret = open_input( enc_path, &input);
+			if (ret == 0)
+			{
+				long long decoded_size = block_decoded_size( input.data, input.size);
+				
+				ret = decoded_size >= 0 && open_output( dec_path, decoded_size, &out) == 0 ? 0 : -1;
+				if (ret == 0)
+				{
+					ret = block_decoding( input.data, input.size, &out, MAX_CODE_LEN, nthreads);
+					if (close_output( &out) < 0) ret = -1;
+				}
+				close_input( &input);
+			}
+		}
+		td = now() - td;
+		
+		int same = encoded >= 0 && ret == 0 && check_large_file( dec_path, size, text, expect, buf);
+		printf( "%s\t%lld\t%.1f\t%.1f\t%s\n", m == 0 ? "huffman" : "block", encoded,
+			size / te / 1e6, size / td / 1e6, same ? "ok" : "FAIL");
+		fflush( stdout);
+		if (!same) ok = 0;
+		remove( enc_path);
+		remove( dec_path);
+	}
+	
+	remove( in_path);
+	free( text);
+	free( expect);
+	free( buf);
+	return ok ? 0 : 1;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// 소스 코드와 비슷한 임의 데이터 생성 (키워드, 식별자, 연산자, 들여쓰기와 줄바꿈)
+static void make_random_source( unsigned char *data, size_t size)
+{
+	static const char *tokens[] = {
+		"int", "char", "return", "if", "else", "for", "while", "struct", "static", "void", "const", "unsigned",
+		"i", "j", "n", "size", "data", "node", "tree", "count", "buf", "len", "ptr", "next",
+		"(", ")", "{", "}", "[", "]", ";", ",", "=", "==", "<", ">", "+", "-", "*", "&", "->", "++",
+		"0", "1", "256", "NULL", "\"%d\\n\"", "// ",
+	};
+	int ntokens = sizeof(tokens) / sizeof(tokens[0]);
+	unsigned long long x = 88172645463325252ULL;
+	size_t i = 0;
+	int depth = 1, col = 0;
+	
+	while (i < size)
+	{
+		const char *t;
+		int r = next_random( &x) % 100;
+		
+		if (r < 8 || col > 60)
+		{
+			// 줄바꿈과 들여쓰기
+			if (r < 2 && depth < 6) depth++;
+			else if (r < 4 && depth > 1) depth--;
+			data[i++] = '\n';
+			for (col = 0; col < depth && i < size; col++) data[i++] = '\t';
+			continue;
+		}
+		// 앞쪽 토큰(키워드, 짧은 식별자)이 더 자주 나옴
+		t = tokens[(next_random( &x) % ntokens) * (next_random( &x) % ntokens) / ntokens];
+		for (; *t && i < size; t++, col++) data[i++] = *t;
+		if (i < size && (r & 1)) data[i++] = ' ';
+	}
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// 바이너리 파일과 비슷한 임의 데이터 생성
+// 32바이트 레코드 : 작은 정수(4), 임의 번호(4), 증가하는 시각(8), 0으로 채운 짧은 이름(16)
+static void make_random_binary( unsigned char *data, size_t size)
+{
+	unsigned long long x = 88172645463325252ULL;
+	unsigned long long time = 1700000000000ULL;
+	unsigned char rec[32];
+	size_t i, k;
+	
+	for (i = 0; i < size; i += sizeof(rec))
+	{
+		unsigned int small = next_random( &x) % 1000;
+		unsigned int id = next_random( &x);
+		int len = 3 + next_random( &x) % 12;
+		
+		time += next_random( &x) % 5000;
+		memset( rec, 0, sizeof(rec));
+		for (k = 0; k < 4; k++) rec[k] = small >> (8 * k);
+		for (k = 0; k < 4; k++) rec[4 + k] = id >> (8 * k);
+		for (k = 0; k < 8; k++) rec[8 + k] = time >> (8 * k);
+		for (k = 0; k < (size_t)len; k++) rec[16 + k] = 'a' + next_random( &x) % 26;
+		memcpy( data + i, rec, size - i < sizeof(rec) ? size - i : sizeof(rec));
+	}
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// 서버 로그와 비슷한 임의 텍스트 생성 (시각, 레벨, 모듈, 반복되는 메시지, 요청 번호와 경로)
+static void make_random_log( unsigned char *data, size_t size)
+{
+	static const char *levels[] = { "INFO", "INFO", "INFO", "DEBUG", "WARN", "ERROR" };
+	static const char *modules[] = { "http", "db", "cache", "auth", "scheduler", "storage" };
+	static const char *messages[] = {
+		"request completed", "connection opened", "connection closed", "cache miss for key",
+		"query executed in", "retrying operation after timeout", "user session refreshed", "job finished with status",
+	};
+	static const char *paths[] = { "/api/v1/users", "/api/v1/orders", "/static/app.js", "/index.html", "/api/v1/login" };
+	unsigned long long x = 88172645463325252ULL;
+	unsigned long long ms = 1700000000000ULL;
+	char line[256];
+	size_t i = 0;
+	
+	while (i < size)
+	{
+		int n;
+		
+		ms += next_random( &x) % 50;
+		n = snprintf( line, sizeof(line), "2024-01-%02llu %02llu:%02llu:%02llu.%03llu [%s] %s: %s id=%llu path=%s %llums\n",
+			1 + ms / 86400000 % 28, ms / 3600000 % 24, ms / 60000 % 60, ms / 1000 % 60, ms % 1000,
+			levels[next_random( &x) % 6], modules[next_random( &x) % 6], messages[next_random( &x) % 8],
+			next_random( &x) % 100000, paths[next_random( &x) % 5], next_random( &x) % 2000);
+		if ((size_t)n > size - i) n = size - i;
+		memcpy( data + i, line, n);
+		i += n;
+	}
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// LZ77 형식의 일치 탐색 정도(1-9)별 압축률과 압축/해제 처리량 (MB/s), 비교용으로 버퍼 API(허프만 코드만)
+// 스레드 하나로 메모리에서 3번 실행하여 가장 빠른 시간을 사용, 압축률은 압축 크기 / 원본 크기
+static void bench_lz( const unsigned char *data, size_t size)
+{
+	unsigned char *back = malloc( size ? size : 1);
+	double t, te, td;
+	int level, rep;
+	
+	printf( "# LZ77, %zu bytes, window %d KB, 1 thread\n", size, 1 << (LZ_DEFAULT_WINDOW_LOG - 10));
+	printf( "# level\tsize\tratio\tencode MB/s\tdecode MB/s\n");
+	
+	// 허프만 코드만 (버퍼 API 한 번)
+	{
+		tCodec *codec = create_codec();
+		unsigned char *comp = malloc( compress_bound( size));
+		long long csize = 0;
+		
+		for (te = td = 0, rep = 0; rep < 3; rep++)
+		{
+			t = now();
+			csize = compress_mem( codec, data, size, comp, compress_bound( size));
+			t = now() - t;
+			if (te == 0 || t < te) te = t;
+			
+			t = now();
+			if (csize < 0 || decompress_mem( codec, comp, csize, back, size) != (long long)size || memcmp( data, back, size) != 0)
+			{
+				fprintf( stderr, "Error: buffer API round trip mismatch\n");
+				exit( 1);
+			}
+			t = now() - t;
+			if (td == 0 || t < td) td = t;
+		}
+		printf( "huffman\t%lld\t%.4f\t%.1f\t%.1f\n", csize, (double)csize / size, size / te / 1e6, size / td / 1e6);
+		free( comp);
+		destroy_codec( codec);
+	}
+	
+	for (level = 1; level <= LZ_MAX_LEVEL; level++)
+	{
+		FILE *fp = NULL;
+		long long encoded = -1;
+		
+		for (te = 0, rep = 0; rep < 3; rep++)
+		{
+			if (fp) fclose( fp);
+			fp = tmpfile();
+			t = now();
+			encoded = lz_encoding( data, size, fp, level, LZ_DEFAULT_WINDOW_LOG);
+			t = now() - t;
+			if (te == 0 || t < te) te = t;
+		}
+		
+		unsigned char *enc = malloc( encoded > 0 ? encoded : 1);
+		rewind( fp);
+		if (encoded < 0 || fread( enc, 1, encoded, fp) != (size_t)encoded)
+		{
+			fprintf( stderr, "Error: cannot encode with LZ77\n");
+			exit( 1);
+		}
+		fclose( fp);
+		
+		for (td = 0, rep = 0; rep < 3; rep++)
+		{
+			t = now();
+			if (lz_decoding( enc, encoded, back, size) < 0 || memcmp( data, back, size) != 0)
+			{
+				fprintf( stderr, "Error: LZ77 round trip mismatch at level %d\n", level);
+				exit( 1);
+			}
+			t = now() - t;
+			if (td == 0 || t < td) td = t;
+		}
+		printf( "%d\t%lld\t%.4f\t%.1f\t%.1f\n", level, encoded, (double)encoded / size, size / te / 1e6, size / td / 1e6);
+		fflush( stdout);
+		free( enc);
+	}
+	
+	free( back);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// 16비트 심볼 데이터 생성 (little-endian 2바이트씩)
+// kind 0 : 센서 값 (천천히 움직이는 12비트 값 + 잡음), 1 : 토큰 번호 (작은 번호일수록 자주 나옴), 2 : 균등 분포
+static void make_random_wide( unsigned char *data, size_t size, int kind)
+{
+	unsigned long long x = 88172645463325252ULL;
+	long level = 2048, step = 1;
+	size_t i;
+	
+	for (i = 0; i + 1 < size; i += 2)
+	{
+		unsigned int v;
+		
+		if (kind == 0)
+		{
+			// 기준값은 0 ~ 4095 사이를 오가고 잡음은 -32 ~ 31
+			if ((i & 0xff) == 0)
+			{
+				level += step;
+				if (level <= 0 || level >= 4095) step = -step;
+			}
+			v = level + (long)(next_random( &x) % 64) - 32;
+			v = v > 4095 ? 4095 : v;
+		}
+		else if (kind == 1) v = (next_random( &x) % 65536) * (next_random( &x) % 65536) / 65536 * (next_random( &x) % 65536) / 65536;
+		else v = next_random( &x) & 0xffff;
+		data[i] = v;
+		data[i + 1] = v >> 8;
+	}
+	if (size & 1) data[size - 1] = 0;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// 16비트 심볼 형식과 바이트 심볼(버퍼 API)의 압축률과 압축/해제 처리량 (MB/s)
+// 생성한 센서 값, 토큰 번호, 균등 분포(65536개 심볼)를 각각 size 바이트
+// 스레드 하나로 메모리에서 3번 실행하여 가장 빠른 시간을 사용, 압축률은 압축 크기 / 원본 크기
+static void bench_wide( size_t size)
+{
+	static const char *names[] = { "sensor", "token", "uniform" };
+	unsigned char *data = malloc( size ? size : 1);
+	unsigned char *back = malloc( size ? size : 1);
+	unsigned char *comp = malloc( compress_bound( size));
+	tCodec *codec = create_codec();
+	double t, te, td;
+	int kind, rep;
+	
+	printf( "# 16-bit symbols, %zu bytes, 1 thread\n", size);
+	printf( "# data\tsymbols\tsize\tratio\tencode MB/s\tdecode MB/s\n");
+	for (kind = 0; kind < 3; kind++)
+	{
+		FILE *fp = NULL;
+		long long csize = 0, encoded = -1;
+		
+		make_random_wide( data, size, kind);
+		
+		// 바이트 심볼
+		for (te = td = 0, rep = 0; rep < 3; rep++)
+		{
+			t = now();
+			csize = compress_mem( codec, data, size, comp, compress_bound( size));
+			t = now() - t;
+			if (te == 0 || t < te) te = t;
+			
+			t = now();
+			if (csize < 0 || decompress_mem( codec, comp, csize, back, size) != (long long)size || memcmp( data, back, size) != 0)
+			{
+				fprintf( stderr, "Error: buffer API round trip mismatch\n");
+				exit( 1);
+			}
+			t = now() - t;
+			if (td == 0 || t < td) td = t;
+		}
+		printf( "%s\t8-bit\t%lld\t%.4f\t%.1f\t%.1f\n", names[kind], csize, (double)csize / size, size / te / 1e6, size / td / 1e6);
+		
+		// 16비트 심볼
+		for (te = 0, rep = 0; rep < 3; rep++)
+		{
+			if (fp) fclose( fp);
+			fp = tmpfile();
+			t = now();
+			encoded = encoding_wide( data, size, 0, fp);
+			t = now() - t;
+			if (te == 0 || t < te) te = t;
+		}
+		
+		unsigned char *enc = malloc( encoded > 0 ? encoded : 1);
+		rewind( fp);
+		if (encoded < 0 || fread( enc, 1, encoded, fp) != (size_t)encoded)
+		{
+			fprintf( stderr, "Error: cannot encode 16-bit symbols\n");
+			exit( 1);
+		}
+		fclose( fp);
+		
+		for (td = 0, rep = 0; rep < 3; rep++)
+		{
+			t = now();
+			if (decoding_wide( enc, encoded, back, size) < 0 || memcmp( data, back, size) != 0)
+			{
+				fprintf( stderr, "Error: 16-bit symbol round trip mismatch\n");
+				exit( 1);
+			}
+			t = now() - t;
+			if (td == 0 || t < td) td = t;
+		}
+		printf( "%s\t16-bit\t%lld\t%.4f\t%.1f\t%.1f\n", names[kind], encoded, (double)encoded / size, size / te / 1e6, size / td / 1e6);
+		fflush( stdout);
+		free( enc);
+	}
+	
+	destroy_codec( codec);
+	free( comp);
+	free( back);
+	free( data);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// 코퍼스 하나의 단계별 처리량을 JSON 한 줄로 출력
+// 빈도 계산, 트리 생성(트리, 코드 길이, 정규 코드), 인코딩(비트열), 디코딩(룩업 테이블)을 각각 3번 실행하여 가장 빠른 시간을 사용
+// 압축률은 허프만 형식 파일의 크기 / 원본 크기
+// 왕복 결과는 비트열 하나와 4-stream 인코딩(블록 형식 -s 4) 모두 확인
+// return value : 0 성공, 1 왕복 결과가 다른 경우
+static int bench_corpus( const char *name, const unsigned char *data, size_t size)
+{
+	long long ch_freq[256];
+	unsigned char lengths[256];
+	unsigned char packed[1 + 256];
+	tCode codes[256];
+	unsigned char *encoded = malloc( STREAMS_BOUND( size));
+	unsigned char *decoded = malloc( size ? size : 1);
+	double best[4] = { 0, 0, 0, 0 };
+	uint64_t nbits = 0;
+	int rep, ok = 1;
+	
+	for (rep = 0; rep < 3; rep++)
+	{
+		double t[5];
+		
+		t[0] = now();
+		memset( ch_freq, 0, sizeof(ch_freq));
+		count_chars_parallel( data, size, ch_freq, default_threads());
+		t[1] = now();
+		tTree *tree = make_huffman_tree( ch_freq);
+		get_code_lengths( tree, lengths);
+		destroyTree( tree);
+		make_canonical_code( lengths, codes);
+		t[2] = now();
+		nbits = encoding_bits( codes, data, size, encoded);
+		t[3] = now();
+		if (decoding_mem( lengths, encoded, (nbits + 7) / 8, decoded, size) < 0 || memcmp( data, decoded, size) != 0) ok = 0;
+		t[4] = now();
+		
+		for (int k = 0; k < 4; k++)
+		{
+			if (rep == 0 || t[k + 1] - t[k] < best[k]) best[k] = t[k + 1] - t[k];
+		}
+	}
+	
+	// 4-stream 인코딩 왕복 (시간은 재지 않음)
+	size_t nbytes = encoding_streams( codes, data, size, encoded);
+	if (decoding_streams( lengths, encoded, nbytes, decoded, size) < 0 || memcmp( data, decoded, size) != 0) ok = 0;
+	
+	long long file_size = 2 + pack_code_lengths( lengths, packed) + (nbits + 7) / 8 + HUF_TAIL_SIZE;
+	printf( "{\"corpus\": \"%s\", \"bytes\": %zu, \"ratio\": %.4f, \"max_code_len\": %d, "
+		"\"hist_mbs\": %.1f, \"tree_us\": %.1f, \"tree_mbs\": %.1f, \"encode_mbs\": %.1f, \"decode_mbs\": %.1f, "
+		"\"round_trip\": %s",
+		name, size, size ? (double)file_size / size : 0.0, max_code_length( lengths),
+		size / best[0] / 1e6, best[1] * 1e6, size / best[1] / 1e6, size / best[2] / 1e6, size / best[3] / 1e6,
+		ok ? "true" : "false");
+	fflush( stdout);
+	
+	free( encoded);
+	free( decoded);
+	return ok ? 0 : 1;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// 코퍼스별 단계별 처리량, 압축률과 최대 메모리 사용량 (한 줄에 코퍼스 하나씩 JSON)
+// 생성한 코퍼스(영문 텍스트, 소스 코드, 바이너리, 치우친 분포, 균등 분포, 4바이트마다 임의 바이트)는 size 바이트, 파일은 파일 크기
+// 최대 메모리 사용량(peak RSS)을 코퍼스마다 따로 재도록 코퍼스마다 자식 프로세스에서 실행
+// return value : 0 성공, 1 실패한 코퍼스가 있는 경우
+static int bench_suite( size_t size, char **files, int nfiles)
+{
+	static const char *names[] = { "text", "source", "binary", "skewed", "uniform", "strided" };
+	int ncorpora = sizeof(names) / sizeof(names[0]) + nfiles;
+	int c, failed = 0;
+	
+	for (c = 0; c < ncorpora; c++)
+	{
+		int status;
+		struct rusage usage;
+		pid_t pid;
+		
+		fflush( stdout);
+		pid = fork();
+		if (pid == 0)
+		{
+			tInput input;
+			const char *name;
+			int ret;
+			
+			if (c < (int)(sizeof(names) / sizeof(names[0])))
+			{
+				name = names[c];
+				input.size = size;
+				input.data = malloc( size ? size : 1);
+				input.mapped = 0;
+				if (c == 0) make_random_text( input.data, size);
+				else if (c == 1) make_random_source( input.data, size);
+				else if (c == 2) make_random_binary( input.data, size);
+				else if (c == 3) make_geometric( input.data, size, 1, 2);
+				else if (c == 5) make_strided( input.data, size);
+				else
+				{
+					unsigned long long x = 88172645463325252ULL;
+					for (size_t i = 0; i < size; i++) input.data[i] = next_random( &x) & 0xff;
+				}
+			}
+			else
+			{
+				name = files[c - sizeof(names) / sizeof(names[0])];
+				if (open_input( name, &input) < 0)
+				{
+					fprintf( stderr, "Error: cannot open file [%s]\n", name);
+					_exit( 2);
+				}
+			}
+			ret = bench_corpus( name, input.data, input.size);
+			close_input( &input);
+			_exit( ret);
+		}
+		
+		if (pid < 0 || wait4( pid, &status, 0, &usage) < 0)
+		{
+			fprintf( stderr, "Error: cannot run benchmark process\n");
+			return 1;
+		}
+		if (WIFEXITED( status) && WEXITSTATUS( status) == 2)
+		{
+			failed = 1;
+			continue;
+		}
+		// 자식이 출력한 줄을 최대 메모리 사용량으로 마무리 (ru_maxrss는 KB 단위)
+		printf( ", \"peak_rss_kb\": %ld}\n", usage.ru_maxrss);
+		if (!WIFEXITED( status) || WEXITSTATUS( status) != 0) failed = 1;
+	}
+	
+	return failed;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// huffman_bench hist [-s size-MB | file]
+// file이 없으면 size-MB 크기(기본값 4096)의 임의 텍스트를 생성하여 사용
+// huffman_bench heap [ops]
+// ops번(기본값 10000000)의 힙 연산을 arity 2, 4, 8에서 실행
+// huffman_bench tree [size-MB]
+// size-MB 크기(기본값 16)의 데이터로 트리 디코더와 디코딩 전용 트리 디코더를 비교
+// huffman_bench msg [total-MB]
+// 1KB ~ 1MB 메시지를 크기마다 total-MB(기본값 256)만큼 버퍼 API로 압축/해제
+// huffman_bench crc [size-MB]
+// size-MB 크기(기본값 256)의 임의 텍스트로 CRC32C의 처리량과 블록 형식에서 체크섬의 비용
+// huffman_bench lz [size-MB] [file]
+// size-MB 크기(기본값 64)의 생성한 로그 텍스트(file이 있으면 file)로 LZ77 형식의 일치 탐색 정도별 압축률과 처리량
+// huffman_bench wide [size-MB]
+// size-MB 크기(기본값 64)의 생성한 16비트 데이터로 16비트 심볼 형식과 바이트 심볼의 압축률과 처리량
+// huffman_bench large [size-GB] [dir]
+// size-GB 크기(기본값 8)의 파일을 dir(기본값 /tmp)에 만들어 왕복하고 비교 (실패하면 1을 반환)
+// huffman_bench suite [-s size-MB] [file...]
+// size-MB 크기(기본값 64)의 생성한 코퍼스와 파일들의 단계별 처리량과 압축률 (JSON lines, 실패하면 1을 반환)
+int main( int argc, char **argv)
+{
+	tInput input;
+	size_t size_mb = 4096;
+	
+	if (argc >= 2 && strcmp( argv[1], "heap") == 0)
+	{
+		bench_heap( argc == 3 ? atoll( argv[2]) : 10000000);
+		return 0;
+	}
+	
+	if (argc >= 2 && strcmp( argv[1], "tree") == 0)
+	{
+		bench_tree( (size_t)(argc == 3 ? atol( argv[2]) : 16) << 20);
+		return 0;
+	}
+	
+	if (argc >= 2 && strcmp( argv[1], "msg") == 0)
+	{
+		bench_msg( (size_t)(argc == 3 ? atol( argv[2]) : 256) << 20);
+		return 0;
+	}
+	
+	if (argc >= 2 && strcmp( argv[1], "crc") == 0)
+	{
+		bench_crc( (size_t)(argc == 3 ? atol( argv[2]) : 256) << 20);
+		return 0;
+	}
+	
+	if (argc >= 2 && strcmp( argv[1], "lz") == 0)
+	{
+		if (argc == 4)
+		{
+			if (open_input( argv[3], &input) < 0)
+			{
+				fprintf( stderr, "Error: cannot open file [%s]\n", argv[3]);
+				return 1;
+			}
+		}
+		else
+		{
+			input.size = (size_t)(argc == 3 ? atol( argv[2]) : 64) << 20;
+			input.data = malloc( input.size ? input.size : 1);
+			input.mapped = 0;
+			make_random_log( input.data, input.size);
+		}
+		bench_lz( input.data, input.size);
+		close_input( &input);
+		return 0;
+	}
+	
+	if (argc >= 2 && strcmp( argv[1], "wide") == 0)
+	{
+		bench_wide( (size_t)(argc == 3 ? atol( argv[2]) : 64) << 20);
+		return 0;
+	}
+	
+	if (argc >= 2 && strcmp( argv[1], "large") == 0)
+	{
+		return bench_large( (long long)(argc >= 3 ? atof( argv[2]) * (1 << 30) : 8LL << 30), argc == 4 ? argv[3] : "/tmp");
+	}
+	
+	if (argc >= 2 && strcmp( argv[1], "suite") == 0)
+	{
+		int first = 2;
+		size_t suite_mb = 64;
+		
+		if (argc >= 4 && strcmp( argv[2], "-s") == 0)
+		{
+			suite_mb = atol( argv[3]);
+			first = 4;
+		}
+		return bench_suite( suite_mb << 20, argv + first, argc - first);
+	}
+	
+	if (argc < 2 || strcmp( argv[1], "hist") != 0)
+	{
+		fprintf( stderr, "%s hist [-s size-MB | file]\n", argv[0]);
+		fprintf( stderr, "%s heap [ops]\n", argv[0]);
+		fprintf( stderr, "%s tree [size-MB]\n", argv[0]);
+		fprintf( stderr, "%s msg [total-MB]\n", argv[0]);
+		fprintf( stderr, "%s crc [size-MB]\n", argv[0]);
+		fprintf( stderr, "%s lz [size-MB] [file]\n", argv[0]);
+		fprintf( stderr, "%s wide [size-MB]\n", argv[0]);
+		fprintf( stderr, "%s large [size-GB] [dir]\n", argv[0]);
+		fprintf( stderr, "%s suite [-s size-MB] [file...]\n", argv[0]);
+		return 1;
+	}
+	
+	if (argc == 3)
+	{
+		if (open_input( argv[2], &input) < 0)
+		{
+			fprintf( stderr, "Error: cannot open file [%s]\n", argv[2]);
+			return 1;
+		}
+	}
+	else
+	{
+		if (argc == 4 && strcmp( argv[2], "-s") == 0) size_mb = atol( argv[3]);
+		input.size = size_mb << 20;
+		input.data = malloc( input.size);
+		input.mapped = 0;
+		if (input.data == NULL)
+		{
+			fprintf( stderr, "Error: not enough memory!\n");
+			return 1;
+		}
+		make_random_text( input.data, input.size);
+	}
+	
+	bench_hist( &input);
+	
+	close_input( &input);
+	return 0;
+}
@@ -1,60 +1,591 @@
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
+#include <unistd.h>
+#include <getopt.h>
+#include <sys/stat.h>
 
 #include "huffman.h"
+#include "block.h"
+#include "archive.h"
+#include "lz77.h"
+#include "parallel.h"
+#include "stats.h"
 
 ////////////////////////////////////////////////////////////////////////////////
-// 문자별 빈도 출력 (for debugging)
-void print_char_freq( int ch_freq[])
+// 입력 파일(fp)의 남은 부분을 모두 메모리에 읽어들임 (표준 입력에도 사용)
+// size : 읽은 바이트 수를 저장
+// return value : 읽어들인 메모리 (free로 해제), 메모리가 부족하거나 읽기에 실패한 경우 NULL
+static unsigned char *read_rest( FILE *fp, size_t *size)
 {
-	int i;
+	size_t capacity = 1 << 12;
+	unsigned char *data = malloc( capacity);
+	size_t n;
 
-	for (i = 0; i < 256; i++)
+	*size = 0;
+	while (data && (n = fread( data + *size, 1, capacity - *size, fp)) > 0)
 	{
-		printf( "%d\t%d\n", i, ch_freq[i]); // 문자인덱스, 빈도
+		*size += n;
+		if (*size == capacity)
+		{
+			unsigned char *p = realloc( data, capacity * 2);
+			if (p == NULL)
+			{
+				free( data);
+				return NULL;
+			}
+			data = p;
+			capacity *= 2;
+		}
 	}
+	if (data && ferror( fp))
+	{
+		free( data);
+		return NULL;
+	}
+	return data;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// 입력 파일(fp)의 크기
+// return value : 바이트 수, 일반 파일이 아닌 경우(파이프 등) -1
+static long long file_size( FILE *fp)
+{
+	struct stat st;
+
+	if (fstat( fileno( fp), &st) < 0 || !S_ISREG( st.st_mode)) return -1;
+	return st.st_size;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// 입출력 바이트 수를 채워서 단계별 시간과 카운터를 stderr에 출력 (--stats)
+// bytes_in : 입력 바이트 수 (모르는 경우 -1), 출력 바이트 수와 심볼 수는 출력 파일에 쓴 바이트 수
+static void report_stats( tStats *st, long long bytes_in, tOutput *out)
+{
+	st->bytes_in = bytes_in;
+	st->bytes_out = st->symbols = out->pos;
+	print_stats( stderr, st, "huffman_decoder");
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// 원본 크기를 알 수 있는 형식의 디코딩 함수 (decode_sized에 넘김)
+// arg : 형식별 추가 인자 (코드 길이 제한, 사전)
+// return value : 0 성공, -1 형식이 맞지 않는 경우
+typedef int (*tDecodeFunc)( const void *arg, const unsigned char *in, size_t in_size, unsigned char *out, size_t out_size);
+
+static int order1_decode( const void *arg, const unsigned char *in, size_t in_size, unsigned char *out, size_t out_size)
+{
+	return decoding_order1( in, in_size, out, out_size, *(const int *)arg);
+}
+
+static int lz_decode( const void *arg, const unsigned char *in, size_t in_size, unsigned char *out, size_t out_size)
+{
+	(void)arg;
+	return lz_decoding( in, in_size, out, out_size);
+}
+
+static int wide_decode( const void *arg, const unsigned char *in, size_t in_size, unsigned char *out, size_t out_size)
+{
+	(void)arg;
+	return decoding_wide( in, in_size, out, out_size);
+}
+
+static long long dict_size( const unsigned char *in, size_t in_size)
+{
+	return dict_decompressed_size( in, in_size, NULL);
+}
+
+static int dict_decode( const void *arg, const unsigned char *in, size_t in_size, unsigned char *out, size_t out_size)
+{
+	return decompress_dict( (const tDict *)arg, in, in_size, out, out_size) == (long long)out_size ? 0 : -1;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// 원본 크기를 알 수 있는 형식 : 출력 파일(out_path)을 그 크기로 만들어 매핑하고 직접 디코딩 (매핑할 수 없으면 메모리에 디코딩하여 출력)
+// decoded_size : 원본 크기를 구하는 함수, decode : 디코딩 함수 (arg를 넘김)
+// invalid_msg : 형식이 맞지 않는 경우의 오류 메시지 (in_path를 출력)
+// bytes_in : --stats에 출력할 입력 바이트 수
+// return value : 0 성공, 1 실패 (오류 메시지를 출력함)
+static int decode_sized( const unsigned char *in, size_t in_size, long long (*decoded_size)( const unsigned char *, size_t),
+	tDecodeFunc decode, const void *arg, const char *invalid_msg, const char *in_path, const char *out_path,
+	tOutput *output, tStats *stats, int show_stats, long long bytes_in)
+{
+	long long size = decoded_size( in, in_size);
+	unsigned char *decoded;
+	int ret = -1;
+
+	if (size < 0)
+	{
+		fprintf( stderr, invalid_msg, in_path);
+		return 1;
+	}
+	if (open_output( out_path, size, output) < 0)
+	{
+		fprintf( stderr, "Error: cannot open file [%s]\n", out_path);
+		return 1;
+	}
+
+	decoded = output->data ? output->data : malloc( size ? size : 1);
+	stats_phase( stats, "decode");
+	if (decoded) ret = decode( arg, in, in_size, decoded, size);
+	if (output->data) output->pos = ret == 0 ? output->size : 0;
+	else if (ret == 0 && write_output( output, decoded, size) < 0) ret = -2;
+	if (!output->data) free( decoded);
+
+	stats_phase( stats, "close");
+	if (close_output( output) < 0 && ret == 0) ret = -2;
+
+	if (ret == -1) fprintf( stderr, invalid_msg, in_path);
+	else if (ret == -2) fprintf( stderr, "Error: cannot write file [%s]\n", out_path);
+	if (ret < 0) return 1;
+	if (show_stats) report_stats( stats, bytes_in, output);
+	return 0;
 }
 
 ////////////////////////////////////////////////////////////////////////////////
-// argv[1] : encoded 파일
-// argv[2] : decoded 파일
+// 원본 크기를 알 수 있는 형식의 입력 파일(in_path)을 메모리에 올려 decode_sized로 디코딩
+// return value : 0 성공, 1 실패 (오류 메시지를 출력함)
+static int decode_file( const char *in_path, long long (*decoded_size)( const unsigned char *, size_t), tDecodeFunc decode, const void *arg,
+	const char *out_path, tOutput *output, tStats *stats, int show_stats)
+{
+	tInput input;
+	int ret;
+
+	if (open_input( in_path, &input) < 0)
+	{
+		fprintf( stderr, "Error: cannot open file [%s]\n", in_path);
+		return 1;
+	}
+	ret = decode_sized( input.data, input.size, decoded_size, decode, arg, "Error: invalid encoded file [%s]\n", in_path, out_path,
+		output, stats, show_stats, input.size);
+	close_input( &input);
+	return ret;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// -m table : 룩업 테이블 디코더 (기본값)
+// -m tree : 비트 단위로 트리를 따라가는 디코더
+// -m flat : 비트 단위로 디코딩 전용 트리(너비 우선 배열)를 따라가는 디코더
+// -L max-len : 허용하는 코드 길이의 최대값 (기본값: 제한 없음)
+// -j threads : 블록 형식 파일을 디코딩할 스레드 수 (기본값: CPU 코어 수)
+// -d dict-file : 사전으로 인코딩된 파일을 디코딩할 사전 (huffman_train)
+// -r offset,length : 원본의 offset 바이트부터 length 바이트만 디코딩 (동기점 인덱스가 있는 허프만 형식 파일)
+// -n member : 아카이브에서 멤버 하나만 해제
+// --stats : 단계별 시간과 카운터를 JSON으로 stderr에 출력
+// argv[optind] : encoded 파일 ("-"이면 표준 입력, 블록/스트림/사전 형식만)
+// argv[optind+1] : decoded 파일 ("-"이면 표준 출력)
+//                  아카이브는 멤버 전체를 해제할 디렉토리 (-n이면 멤버를 저장할 파일)
 int main( int argc, char **argv)
 {
-	FILE *infp, *outfp;
-	int ch_freq[256] = {0,}; // 문자별 빈도
-	tNode *huffman_tree; // 허프만 트리
+	FILE *infp;
+	tOutput output; // 디코딩 결과를 쓰는 출력 파일
+	unsigned char lengths[256]; // 문자별 코드 길이
+	tTree *huffman_tree; // 허프만 트리
+	int use_table = 1; // 디코더 종류
+	int use_flat = 0; // 트리 디코더에서 디코딩 전용 트리를 사용
+	int max_len = MAX_CODE_LEN; // 코드 길이 제한
+	int nthreads = default_threads(); // 스레드 수
+	unsigned char header[BLOCK_HEADER_SIZE]; // 파일 헤더 (magic으로 형식 구분)
+	const char *dict_path = NULL; // 사전 파일
+	int show_stats = 0; // 단계별 시간과 카운터 출력
+	long long range_offset = -1, range_length = 0; // 디코딩할 원본 구간 (-r, offset < 0이면 전체)
+	const char *member = NULL; // 아카이브에서 해제할 멤버 (NULL이면 전체)
+	tStats stats; // 단계별 시간과 카운터
+	static const struct option long_options[] = { { "stats", no_argument, NULL, 'T' }, { NULL, 0, NULL, 0 } };
+	int opt;
+	
+	stats_init( &stats);
+	while ((opt = getopt_long( argc, argv, "m:L:j:d:r:n:", long_options, NULL)) != -1)
+	{
+		if (opt == 'm' && strcmp( optarg, "table") == 0) use_table = 1;
+		else if (opt == 'm' && strcmp( optarg, "tree") == 0) use_table = use_flat = 0;
+		else if (opt == 'm' && strcmp( optarg, "flat") == 0)
+		{
+			use_table = 0;
+			use_flat = 1;
+		}
+		else if (opt == 'L' && atoi( optarg) >= 1 && atoi( optarg) <= MAX_CODE_LEN) max_len = atoi( optarg);
+		else if (opt == 'j' && atoi( optarg) >= 1) nthreads = atoi( optarg);
+		else if (opt == 'd') dict_path = optarg;
+		else if (opt == 'n') member = optarg;
+		else if (opt == 'T') show_stats = 1;
+		else if (opt == 'r' && sscanf( optarg, "%lld,%lld", &range_offset, &range_length) == 2
+			&& range_offset >= 0 && range_length >= 0) ;
+		else
+		{
+			fprintf( stderr, "%s [-m table|tree|flat] [-L max-len] [-j threads] [-d dict-file] [-r offset,length] [-n member] [--stats] encoded-file decoded-file|directory\n", argv[0]);
+			return 1;
+		}
+	}
 	
-	if (argc != 3)
+	if (argc - optind != 2)
 	{
-		fprintf( stderr, "%s encoded-file decoded-file\n", argv[0]);
+		fprintf( stderr, "%s [-m table|tree|flat] [-L max-len] [-j threads] [-d dict-file] [-r offset,length] [-n member] [--stats] encoded-file decoded-file|directory\n", argv[0]);
 		return 1;
 	}
+	argv += optind - 1;
+
+	// 원본의 일부 구간 : 동기점 인덱스로 구간이 속한 위치부터 디코딩
+	if (range_offset >= 0)
+	{
+		tInput input;
+		unsigned char *decoded;
+		long long ret = -1;
+
+		stats_phase( &stats, "header");
+		if (open_input( argv[1], &input) < 0)
+		{
+			fprintf( stderr, "Error: cannot open file [%s]\n", argv[1]);
+			return 1;
+		}
+
+		long long decoded_size = indexed_decoded_size( input.data, input.size);
+		if (decoded_size < 0)
+		{
+			fprintf( stderr, "Error: no sync index in [%s] (encode with -x)\n", argv[1]);
+			close_input( &input);
+			return 1;
+		}
+		if (range_offset > decoded_size) range_offset = decoded_size;
+		if (range_length > decoded_size - range_offset) range_length = decoded_size - range_offset;
+
+		if (open_output( argv[2], range_length, &output) < 0)
+		{
+			fprintf( stderr, "Error: cannot open file [%s]\n", argv[2]);
+			close_input( &input);
+			return 1;
+		}
+
+		// 매핑한 출력 파일에 직접, 아니면 메모리에 디코딩하여 출력
+		stats_phase( &stats, "decode");
+		decoded = output.data ? output.data : malloc( range_length ? range_length : 1);
+		if (decoded) ret = decoding_range( input.data, input.size, range_offset, range_length, decoded);
+		if (output.data) output.pos = ret == range_length ? output.size : 0;
+		else if (ret == range_length && write_output( &output, decoded, range_length) < 0) ret = -2;
+		if (!output.data) free( decoded);
+
+		stats_phase( &stats, "close");
+		int write_error = close_output( &output) < 0 || ret == -2;
+		close_input( &input);
+
+		if (ret == -1)
+		{
+			fprintf( stderr, "Error: invalid encoded file [%s]\n", argv[1]);
+			return 1;
+		}
+		if (write_error)
+		{
+			fprintf( stderr, "Error: cannot write file [%s]\n", argv[2]);
+			return 1;
+		}
+		if (show_stats) report_stats( &stats, -1, &output);
+		return 0;
+	}
 
 	// 입력 파일 (바이너리)
-	infp = fopen( argv[1], "rb");
+	int from_stdin = strcmp( argv[1], "-") == 0;
+	infp = from_stdin ? stdin : fopen( argv[1], "rb");
+	if (infp == NULL)
+	{
+		fprintf( stderr, "Error: cannot open file [%s]\n", argv[1]);
+		return 1;
+	}
 
-	// 256개의 정수
-	get_char_freq( infp, ch_freq);
+	stats_phase( &stats, "header");
+	int has_magic = fread( header, 1, 2, infp) == 2;
+	int is_block = has_magic && memcmp( header, BLOCK_MAGIC, 2) == 0;
 
-	// 문자별 빈도 출력 (only for debugging)
-	//print_char_freq( ch_freq);
-	
-	// 허프만 트리 생성
-	huffman_tree = make_huffman_tree( ch_freq);
-	
-	// 출력: 텍스트 파일
-	outfp = fopen( argv[2], "wt");
+	// 사전으로 인코딩된 파일 : magic 다음의 메시지 전체를 읽어서 사전의 디코딩 테이블로 디코딩
+	if (has_magic && memcmp( header, DICT_FILE_MAGIC, 2) == 0)
+	{
+		stats_phase( &stats, "table");
+		FILE *dictfp = dict_path ? fopen( dict_path, "rb") : NULL;
+		tDict *dict = dictfp ? read_dict( dictfp) : NULL;
+		unsigned char *src;
+		size_t src_size;
+
+		if (dictfp) fclose( dictfp);
+		if (dict == NULL)
+		{
+			if (dict_path) fprintf( stderr, "Error: invalid dictionary file [%s]\n", dict_path);
+			else fprintf( stderr, "Error: dictionary required for [%s] (-d dict-file)\n", argv[1]);
+			if (!from_stdin) fclose( infp);
+			return 1;
+		}
+
+		stats_phase( &stats, "read");
+		src = read_rest( infp, &src_size);
+		if (!from_stdin) fclose( infp);
+		if (src == NULL)
+		{
+			fprintf( stderr, "Error: cannot read file [%s]\n", argv[1]);
+			destroy_dict( dict);
+			return 1;
+		}
+
+		int ret = decode_sized( src, src_size, dict_size, dict_decode, dict, "Error: invalid encoded file or wrong dictionary [%s]\n",
+			argv[1], argv[2], &output, &stats, show_stats, 2 + src_size);
+		free( src);
+		destroy_dict( dict);
+		return ret;
+	}
+
+	// 아카이브 : 목차로 멤버를 찾아 멤버 전체(디렉토리 아래) 또는 멤버 하나를 병렬로 해제
+	if (has_magic && memcmp( header, ARCHIVE_MAGIC, 2) == 0)
+	{
+		tInput input;
+		long long num_bytes = 0;
+		int ret;
+
+		if (!from_stdin) fclose( infp);
+		if (from_stdin || open_input( argv[1], &input) < 0)
+		{
+			fprintf( stderr, from_stdin ? "Error: archive must be a file, not standard input\n" : "Error: cannot open file [%s]\n", argv[1]);
+			return 1;
+		}
+
+		if (member == NULL)
+		{
+			stats_phase( &stats, "decode");
+			ret = archive_extract_all( input.data, input.size, argv[2], nthreads, &num_bytes);
+			output.pos = num_bytes;
+		}
+		else
+		{
+			long long decoded_size = archive_member_size( input.data, input.size, member);
+
+			if (decoded_size < 0)
+			{
+				int invalid = archive_count( input.data, input.size) < 0;
+				fprintf( stderr, invalid ? "Error: invalid encoded file [%s]\n" : "Error: no member [%s] in archive\n", invalid ? argv[1] : member);
+				close_input( &input);
+				return 1;
+			}
+			if (open_output( argv[2], decoded_size, &output) < 0)
+			{
+				fprintf( stderr, "Error: cannot open file [%s]\n", argv[2]);
+				close_input( &input);
+				return 1;
+			}
+
+			stats_phase( &stats, "decode");
+			ret = archive_extract_member( input.data, input.size, member, &output, nthreads);
+			stats_phase( &stats, "close");
+			if (close_output( &output) < 0 && ret == 0) ret = -2;
+			if (ret == -2) fprintf( stderr, "Error: cannot write file [%s]\n", argv[2]);
+			if (ret == -3) fprintf( stderr, "Error: checksum mismatch [%s]\n", member);
+		}
+		long long bytes_in = input.size;
+		close_input( &input);
+
+		if (ret == -1) fprintf( stderr, "Error: invalid encoded file [%s]\n", argv[1]);
+		if (ret < 0) return 1;
+		if (show_stats) report_stats( &stats, bytes_in, &output);
+		return 0;
+	}
+
+	// order-1 형식 : 원본 크기를 알 수 있으므로 출력 파일을 그 크기로 만들어 매핑하고 직접 디코딩
+	if (has_magic && memcmp( header, ORDER1_MAGIC, 2) == 0 && !from_stdin)
+	{
+		fclose( infp);
+		return decode_file( argv[1], order1_decoded_size, order1_decode, &max_len, argv[2], &output, &stats, show_stats);
+	}
+
+	// LZ77 형식 : 원본 크기를 알 수 있으므로 출력 파일을 그 크기로 만들어 매핑하고 직접 디코딩
+	if (has_magic && memcmp( header, LZ_MAGIC, 2) == 0 && !from_stdin)
+	{
+		fclose( infp);
+		return decode_file( argv[1], lz_decoded_size, lz_decode, NULL, argv[2], &output, &stats, show_stats);
+	}
+
+	// 16비트 심볼 형식 : 원본 크기를 알 수 있으므로 출력 파일을 그 크기로 만들어 매핑하고 직접 디코딩
+	if (has_magic && memcmp( header, WIDE_MAGIC, 2) == 0 && !from_stdin)
+	{
+		fclose( infp);
+		return decode_file( argv[1], wide_decoded_size, wide_decode, NULL, argv[2], &output, &stats, show_stats);
+	}
+
+	// 스트림 형식이거나 표준 입력으로 들어오는 블록 형식 : 앞에서부터 블록 단위로 디코딩하여 바로 출력
+	if (is_block && fread( header + 2, 1, BLOCK_HEADER_SIZE - 2, infp) == BLOCK_HEADER_SIZE - 2
+		&& ((header[3] & BLOCK_STREAMED) || from_stdin))
+	{
+		if (open_output( argv[2], -1, &output) < 0)
+		{
+			fprintf( stderr, "Error: cannot open file [%s]\n", argv[2]);
+			if (!from_stdin) fclose( infp);
+			return 1;
+		}
+
+		stats_phase( &stats, "decode");
+		int ret = block_decoding_stream( header, infp, &output, max_len);
+		stats_phase( &stats, "close");
+		int write_error = close_output( &output) < 0;
+		long long bytes_in = from_stdin ? -1 : ftello( infp);
+
+		if (!from_stdin) fclose( infp);
+
+		if (ret < 0)
+		{
+			fprintf( stderr, ret == -2 ? "Error: checksum mismatch [%s]\n" : "Error: invalid encoded file [%s]\n", argv[1]);
+			return 1;
+		}
+		if (write_error)
+		{
+			fprintf( stderr, "Error: cannot write file [%s]\n", argv[2]);
+			return 1;
+		}
+		if (show_stats) report_stats( &stats, bytes_in, &output);
+		return 0;
+	}
+
+	// 블록 형식 파일 : 블록 인덱스를 이용하여 병렬로 디코딩
+	// 원본 크기를 알 수 있으므로 출력 파일을 그 크기로 만들어 매핑하고 블록마다 제 위치에 디코딩
+	if (is_block)
+	{
+		tInput input;
+
+		fclose( infp);
+		if (open_input( argv[1], &input) < 0)
+		{
+			fprintf( stderr, "Error: cannot open file [%s]\n", argv[1]);
+			return 1;
+		}
 
-	// 허프만 트리를 이용하여 디코딩
-	decoding( huffman_tree, infp, outfp);
+		long long decoded_size = block_decoded_size( input.data, input.size);
+		if (decoded_size < 0)
+		{
+			fprintf( stderr, "Error: invalid encoded file [%s]\n", argv[1]);
+			close_input( &input);
+			return 1;
+		}
 
-	// 허프만 트리 메모리 해제
-	destroyTree( huffman_tree);
+		if (open_output( argv[2], decoded_size, &output) < 0)
+		{
+			fprintf( stderr, "Error: cannot open file [%s]\n", argv[2]);
+			close_input( &input);
+			return 1;
+		}
 
+		stats_phase( &stats, "decode");
+		int ret = block_decoding( input.data, input.size, &output, max_len, nthreads);
+		stats_phase( &stats, "close");
+		int write_error = close_output( &output) < 0;
+		long long bytes_in = input.size;
+
+		close_input( &input);
+
+		if (ret < 0)
+		{
+			fprintf( stderr, ret == -2 ? "Error: checksum mismatch [%s]\n" : "Error: invalid encoded file [%s]\n", argv[1]);
+			return 1;
+		}
+		if (write_error)
+		{
+			fprintf( stderr, "Error: cannot write file [%s]\n", argv[2]);
+			return 1;
+		}
+		if (show_stats) report_stats( &stats, bytes_in, &output);
+		return 0;
+	}
+
+	// 트리/테이블 디코더는 파일 끝의 비트 수를 읽으므로 표준 입력을 사용할 수 없음 (order-1 형식도 파일로만)
+	if (from_stdin)
+	{
+		fprintf( stderr, "Error: standard input must be in block, stream or dictionary format\n");
+		return 1;
+	}
+	rewind( infp);
+
+	// 256개의 코드 길이
+	if (read_code_lengths( infp, lengths) < 0)
+	{
+		fprintf( stderr, "Error: invalid encoded file [%s]\n", argv[1]);
+		fclose( infp);
+		return 1;
+	}
+
+	// 코드 길이 제한보다 긴 코드로 인코딩된 파일은 거부
+	if (max_code_length( lengths) > max_len)
+	{
+		fprintf( stderr, "Error: code length %d exceeds limit %d [%s]\n", max_code_length( lengths), max_len, argv[1]);
+		fclose( infp);
+		return 1;
+	}
+
+	// 출력: 텍스트 파일 (원본 크기를 모르므로 버퍼에 모아서 출력)
+	if (open_output( argv[2], -1, &output) < 0)
+	{
+		fprintf( stderr, "Error: cannot open file [%s]\n", argv[2]);
+		fclose( infp);
+		return 1;
+	}
+
+	if (use_table)
+	{
+		// 코드 길이로부터 만든 룩업 테이블을 이용하여 디코딩 (테이블 생성은 디코딩 시간에 포함)
+		stats_phase( &stats, "decode");
+		if (decoding_table( lengths, infp, &output) < 0)
+		{
+			fprintf( stderr, "Error: invalid encoded file [%s]\n", argv[1]);
+			fclose( infp);
+			close_output( &output);
+			return 1;
+		}
+	}
+	else
+	{
+		// 코드 길이로부터 허프만 트리 생성
+		stats_phase( &stats, "tree");
+		huffman_tree = make_code_tree( lengths);
+		if (huffman_tree == NULL)
+		{
+			fprintf( stderr, "Error: invalid code lengths [%s]\n", argv[1]);
+			fclose( infp);
+			close_output( &output);
+			return 1;
+		}
+
+		if (use_flat)
+		{
+			// 디코딩 전용 트리를 이용하여 디코딩
+			tFlatTree *flat_tree = make_flat_tree( huffman_tree);
+			if (flat_tree == NULL)
+			{
+				fprintf( stderr, "Error: invalid code lengths [%s]\n", argv[1]);
+				destroyTree( huffman_tree);
+				fclose( infp);
+				close_output( &output);
+				return 1;
+			}
+			stats_phase( &stats, "decode");
+			decoding_flat( flat_tree, infp, &output);
+			destroy_flat_tree( flat_tree);
+		}
+		// 허프만 트리를 이용하여 디코딩
+		else
+		{
+			stats_phase( &stats, "decode");
+			decoding( huffman_tree, infp, &output);
+		}
+
+		// 허프만 트리 메모리 해제
+		destroyTree( huffman_tree);
+	}
+
+	stats_phase( &stats, "close");
+	long long bytes_in = file_size( infp);
 	fclose( infp);
-	fclose( outfp);
+	if (close_output( &output) < 0)
+	{
+		fprintf( stderr, "Error: cannot write file [%s]\n", argv[2]);
+		return 1;
+	}
+	if (show_stats)
+	{
+		stats.max_code_len = max_code_length( lengths);
+		for (int i = 0; i < 256; i++) stats.alphabet += lengths[i] > 0;
+		report_stats( &stats, bytes_in, &output);
+	}
 	
 	return 0;
 }
-
@@ -1,86 +1,591 @@
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include <getopt.h>
 
 #include "huffman.h"
+#include "parallel.h"
+#include "block.h"
+#include "archive.h"
+#include "lz77.h"
+#include "stats.h"
 
 ////////////////////////////////////////////////////////////////////////////////
 // 문자별 빈도 출력 (for debugging)
-void print_char_freq( int ch_freq[])
+void print_char_freq( long long ch_freq[])
 {
 	int i;
 
 	for (i = 0; i < 256; i++)
 	{
-		printf( "%d\t%d\n", i, ch_freq[i]); // 문자인덱스, 빈도
+		printf( "%d\t%lld\n", i, ch_freq[i]); // 문자인덱스, 빈도
 	}
 }
 
 ////////////////////////////////////////////////////////////////////////////////
-// argv[1] : 입력 텍스트 파일
-// argv[2] : encoded 파일
+// 코드 길이로 인코딩했을 때의 전체 비트 수
+static double code_bits( long long ch_freq[], unsigned char lengths[])
+{
+	double bits = 0;
+	int i;
+
+	for (i = 0; i < 256; i++)
+	{
+		bits += (double)ch_freq[i] * lengths[i];
+	}
+	return bits;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// 원본/압축 크기와 압축률 출력
+static void print_ratio( FILE *fp, long long num_bytes, long long encoded_bytes)
+{
+	fprintf( fp, "# of bytes of the original text = %lld\n", num_bytes);
+	fprintf( fp, "# of bytes of the compressed text = %lld\n", encoded_bytes);
+	fprintf( fp, "compression ratio = %.2f\n", ((float)num_bytes - encoded_bytes) / num_bytes * 100);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// 출력 파일을 닫음 (표준 출력이면 비우기만 함)
+// 그동안의 fwrite 실패는 ferror로 확인
+// return value : 0 성공, -1 쓰기에 실패한 경우
+static int close_encoded( FILE *outfp)
+{
+	int error = ferror( outfp);
+
+	if (outfp == stdout) error |= fflush( outfp) != 0;
+	else error |= fclose( outfp) != 0;
+	return error ? -1 : 0;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// -L max-len : 코드 길이의 최대값 (기본값: 제한 없음)
+// -j threads : 사용할 스레드 수 (기본값: CPU 코어 수)
+// -b block-KB : 블록 형식으로 인코딩 (블록 크기, KB 단위)
+// -s streams : 블록마다의 비트열 수 (1 또는 4, 블록 형식으로 인코딩)
+// -o order : 문맥 모델의 차수 (0 : 문자 빈도 하나로 만든 코드 (기본값), 1 : 앞 문자별 코드)
+// -S : 스트림 형식 (입력을 창(블록) 단위로 도착하는 대로 인코딩, 파이프 입력용)
+// -t latency-ms : 스트림 형식에서 입력이 창에 들어온 뒤 블록으로 출력될 때까지의 최대 시간 (기본값: 1000)
+// -d dict-file : 미리 학습한 사전(huffman_train)의 코드로 인코딩 (코드 길이 헤더 대신 사전 번호를 저장)
+// -x sync-KB : 원본 sync-KB마다 동기점을 기록하여 인덱스를 저장 (기본값: 64, 0이면 저장하지 않음, 기본 형식에서만 사용)
+// -k : 블록(아카이브는 조각)마다 원본의 CRC32C를 저장하여 디코딩할 때 확인 (블록 형식으로 인코딩)
+// -z level : LZ77 형식 (앞에 나온 문자열을 (거리, 길이)로 바꾼 다음 허프만 코드로 인코딩, 일치 탐색의 정도 1-9)
+// -w window-log : LZ77 형식의 창 크기 log2 (기본값: 16, LZ77 형식으로 인코딩)
+// -W : 16비트 심볼 형식 (입력을 2바이트 단위의 심볼로 보고 최대 65536개 심볼의 코드로 인코딩)
+// -a : 아카이브 형식 (여러 파일을 파일마다 압축하여 하나의 아카이브로 저장, 파일 단위로 병렬 처리)
+// -c : 허프만 코드를 출력 (stdout, 출력 파일이 표준 출력이 아닌 경우)
+// --stats : 단계별 시간과 카운터를 JSON으로 stderr에 출력
+// argv[optind] : 입력 텍스트 파일 ("-"이면 표준 입력)
+// argv[optind+1] : encoded 파일 ("-"이면 표준 출력, 코드와 압축률은 stderr로 출력)
+// 아카이브 형식 (-a) : argv[optind]는 아카이브 파일, argv[optind+1] ...는 파일, 디렉토리, "@목록파일" ("@-"이면 표준 입력)
 int main( int argc, char **argv)
 {
-	FILE *infp, *outfp;
-	int ch_freq[256] = {0,}; // 문자별 빈도
-	char *codes[256]; // 문자별 허프만 코드 (ragged 배열)
-	tNode *huffman_tree; // 허프만 트리
+	FILE *outfp;
+	tInput input; // 메모리에 올린 입력 파일
+	long long ch_freq[256] = {0,}; // 문자별 빈도
+	tCode codes[256]; // 문자별 허프만 코드 (정수 코드 + 비트 길이)
+	unsigned char lengths[256]; // 문자별 코드 길이
+	tTree *huffman_tree; // 허프만 트리
+	int max_len = 0; // 코드 길이 제한 (0이면 제한 없음)
+	int nthreads = default_threads(); // 스레드 수
+	size_t block_size = 0; // 블록 크기 (0이면 블록 형식을 사용하지 않음)
+	int streams = 1; // 블록마다의 비트열 수
+	int stream_mode = 0; // 스트림 형식
+	int order = 0; // 문맥 모델의 차수
+	int latency_ms = 1000; // 스트림 형식의 최대 대기 시간
+	const char *dict_path = NULL; // 사전 파일
+	size_t sync_interval = DEFAULT_SYNC_INTERVAL; // 동기점 간격 (0이면 인덱스를 저장하지 않음)
+	int sync_option = 0; // -x를 지정함
+	FILE *info; // 압축률 등을 출력할 곳
+	int print_codes = 0; // 허프만 코드 출력
+	int archive_mode = 0; // 아카이브 형식
+	int checksum = 0; // 블록마다 CRC32C 저장
+	int lz_level = 0; // LZ77 형식의 일치 탐색 정도 (0이면 LZ77 형식을 사용하지 않음)
+	int window_log = 0; // LZ77 형식의 창 크기 log2
+	int wide = 0; // 16비트 심볼 형식
+	int show_stats = 0; // 단계별 시간과 카운터 출력
+	tStats stats; // 단계별 시간과 카운터
+	static const struct option long_options[] = { { "stats", no_argument, NULL, 'T' }, { NULL, 0, NULL, 0 } };
+	int opt, bad = 0;
 	
-	if (argc != 3)
+	stats_init( &stats);
+	while ((opt = getopt_long( argc, argv, "L:j:b:s:St:o:d:x:kz:w:Wac", long_options, NULL)) != -1)
 	{
-		fprintf( stderr, "%s input-file encoded-file\n", argv[0]);
+		if (opt == 'L')
+		{
+			max_len = atoi( optarg);
+			if (max_len < 1 || max_len > MAX_CODE_LEN) bad = 1;
+		}
+		else if (opt == 'j')
+		{
+			nthreads = atoi( optarg);
+			if (nthreads < 1) bad = 1;
+		}
+		else if (opt == 'b')
+		{
+			block_size = (size_t)atol( optarg) << 10;
+			if (block_size < MIN_BLOCK_SIZE || block_size > MAX_BLOCK_SIZE) bad = 1;
+		}
+		else if (opt == 's')
+		{
+			streams = atoi( optarg);
+			if (streams != 1 && streams != NUM_STREAMS) bad = 1;
+		}
+		else if (opt == 'S') stream_mode = 1;
+		else if (opt == 'o')
+		{
+			order = atoi( optarg);
+			if (order != 0 && order != 1) bad = 1;
+		}
+		else if (opt == 't')
+		{
+			latency_ms = atoi( optarg);
+			if (latency_ms < 0) bad = 1;
+		}
+		else if (opt == 'd') dict_path = optarg;
+		else if (opt == 'x')
+		{
+			sync_interval = (size_t)atol( optarg) << 10;
+			sync_option = 1;
+			if (atol( optarg) < 0) bad = 1;
+		}
+		else if (opt == 'k') checksum = 1;
+		else if (opt == 'z')
+		{
+			lz_level = atoi( optarg);
+			if (lz_level < 1 || lz_level > LZ_MAX_LEVEL) bad = 1;
+		}
+		else if (opt == 'w')
+		{
+			window_log = atoi( optarg);
+			if (window_log < LZ_MIN_WINDOW_LOG || window_log > LZ_MAX_WINDOW_LOG) bad = 1;
+		}
+		else if (opt == 'W') wide = 1;
+		else if (opt == 'a') archive_mode = 1;
+		else if (opt == 'c') print_codes = 1;
+		else if (opt == 'T') show_stats = 1;
+		else bad = 1;
+	}
+	if (window_log > 0 && lz_level == 0) lz_level = LZ_DEFAULT_LEVEL;
+	if (lz_level > 0 && window_log == 0) window_log = LZ_DEFAULT_WINDOW_LOG;
+	if ((streams > 1 || stream_mode || (checksum && !archive_mode)) && block_size == 0) block_size = DEFAULT_BLOCK_SIZE;
+	if (order == 1 && block_size > 0) bad = 1; // order-1은 블록/스트림 형식을 지원하지 않음
+	if (dict_path && (block_size > 0 || order == 1 || max_len > 0)) bad = 1; // 사전은 코드가 정해져 있음
+	if (archive_mode && (block_size > 0 || order == 1 || dict_path || max_len > 0)) bad = 1; // 아카이브는 파일마다 버퍼 API로 압축
+	if (lz_level > 0 && (block_size > 0 || order == 1 || dict_path || max_len > 0 || archive_mode)) bad = 1; // LZ77 형식은 스트림별로 버퍼 API로 압축
+	if (wide && (block_size > 0 || order == 1 || dict_path || archive_mode || lz_level > 0)) bad = 1; // 16비트 심볼은 파일 전체를 코드 하나로
+	if (sync_option && (block_size > 0 || order == 1 || dict_path || archive_mode || lz_level > 0 || wide)) bad = 1; // 동기점 인덱스는 기본 형식에만 있음
+
+	if (bad || (archive_mode ? argc - optind < 2 : argc - optind != 2))
+	{
+		fprintf( stderr, "%s [-L max-len(1-%d)] [-j threads] [-x sync-KB] [-c] [--stats] input-file encoded-file\n", argv[0], MAX_CODE_LEN);
+		fprintf( stderr, "%s [-L max-len(1-%d)] [-j threads] [-b block-KB(%d-%d)] [-s 1|4] [-S [-t latency-ms]] [-o 0|1] [-d dict-file] [-k] [-c] [--stats] input-file encoded-file\n",
+			argv[0], MAX_CODE_LEN, MIN_BLOCK_SIZE >> 10, MAX_BLOCK_SIZE >> 10);
+		fprintf( stderr, "%s -W [-L max-len(1-%d)] [--stats] input-file encoded-file\n", argv[0], WIDE_MAX_CODE_LEN);
+		fprintf( stderr, "%s -z level(1-%d) [-w window-log(%d-%d)] [--stats] input-file encoded-file\n", argv[0], LZ_MAX_LEVEL, LZ_MIN_WINDOW_LOG, LZ_MAX_WINDOW_LOG);
+		fprintf( stderr, "%s -a [-j threads] [-k] [--stats] archive-file file|directory|@list-file...\n", argv[0]);
 		return 1;
 	}
+	int npaths = argc - optind - 1;
+	argv += optind - 1;
+	info = strcmp( argv[archive_mode ? 1 : 2], "-") == 0 ? stderr : stdout;
 
 	////////////////////////////////////////
-	// 입력 텍스트 파일
-	infp = fopen( argv[1], "rt");
-	if (infp == NULL)
+	// 아카이브 형식 : 파일 목록을 만들고 파일마다 병렬로 압축하여 목차와 함께 저장
+	if (archive_mode)
+	{
+		int count;
+		long long num_bytes;
+
+		stats_phase( &stats, "list");
+		tArchiveFile *files = list_archive_files( argv + 2, npaths, &count);
+		if (files == NULL) return 1;
+
+		outfp = strcmp( argv[1], "-") == 0 ? stdout : fopen( argv[1], "wb");
+		if (outfp == NULL)
+		{
+			fprintf( stderr, "Error: cannot open file [%s]\n", argv[1]);
+			free_archive_files( files, count);
+			return 1;
+		}
+
+		stats_phase( &stats, "encode");
+		long long encoded_bytes = archive_encoding( files, count, outfp, nthreads, checksum, &num_bytes);
+
+		stats_phase( &stats, "close");
+		if (close_encoded( outfp) < 0)
+		{
+			fprintf( stderr, "Error: cannot write file [%s]\n", argv[1]);
+			encoded_bytes = -1;
+		}
+		free_archive_files( files, count);
+		if (encoded_bytes < 0) return 1;
+
+		fprintf( info, "# of files = %d\n", count);
+		print_ratio( info, num_bytes, encoded_bytes);
+		if (show_stats)
+		{
+			stats.bytes_in = stats.symbols = num_bytes;
+			stats.bytes_out = encoded_bytes;
+			print_stats( stderr, &stats, "huffman_encoder");
+		}
+		return 0;
+	}
+
+	////////////////////////////////////////
+	// 스트림 형식 : 입력 전체를 올리지 않고 창 단위로 읽어서 인코딩
+	if (stream_mode)
+	{
+		int fd = strcmp( argv[1], "-") == 0 ? 0 : open( argv[1], O_RDONLY);
+		long long num_bytes;
+
+		if (fd < 0)
+		{
+			fprintf( stderr, "Error: cannot open file [%s]\n", argv[1]);
+			return 1;
+		}
+		outfp = strcmp( argv[2], "-") == 0 ? stdout : fopen( argv[2], "wb");
+		if (outfp == NULL)
+		{
+			fprintf( stderr, "Error: cannot open file [%s]\n", argv[2]);
+			if (fd != 0) close( fd);
+			return 1;
+		}
+
+		stats_phase( &stats, "encode");
+		long long encoded_bytes = block_encoding_stream( fd, outfp, block_size, max_len, streams | (checksum ? BLOCK_CHECKSUM : 0), latency_ms, &num_bytes);
+
+		int write_error = close_encoded( outfp) < 0;
+		if (fd != 0) close( fd);
+
+		if (write_error)
+		{
+			fprintf( stderr, "Error: cannot write file [%s]\n", argv[2]);
+			return 1;
+		}
+		if (encoded_bytes < 0)
+		{
+			fprintf( stderr, "Error: cannot encode stream with max code length %d\n", max_len);
+			return 1;
+		}
+		print_ratio( info, num_bytes, encoded_bytes);
+		if (show_stats)
+		{
+			stats.bytes_in = stats.symbols = num_bytes;
+			stats.bytes_out = encoded_bytes;
+			print_stats( stderr, &stats, "huffman_encoder");
+		}
+		return 0;
+	}
+
+	////////////////////////////////////////
+	// 입력 텍스트 파일 (한번만 읽어서 빈도 계산과 인코딩에 사용)
+	stats_phase( &stats, "read");
+	if (open_input( argv[1], &input) < 0)
 	{
 		fprintf( stderr, "Error: cannot open file [%s]\n", argv[1]);
 		return 1;
 	}
 
-	// 텍스트 파일로부터 문자별 빈도 저장
-	int num_bytes = read_chars( infp, ch_freq);
+	////////////////////////////////////////
+	// 사전 : 미리 학습한 코드로 인코딩 (빈도를 세거나 트리를 만들지 않음)
+	if (dict_path)
+	{
+		stats_phase( &stats, "dict");
+		FILE *dictfp = fopen( dict_path, "rb");
+		tDict *dict = dictfp ? read_dict( dictfp) : NULL;
 
-	fclose( infp);
+		if (dictfp) fclose( dictfp);
+		if (dict == NULL)
+		{
+			fprintf( stderr, "Error: invalid dictionary file [%s]\n", dict_path);
+			close_input( &input);
+			return 1;
+		}
+
+		stats_phase( &stats, "encode");
+		size_t cap = compress_dict_bound( dict, input.size);
+		unsigned char *encoded = malloc( cap);
+		long long encoded_bytes = encoded ? compress_dict( dict, input.data, input.size, encoded, cap) : -1;
+		int ret = encoded_bytes < 0;
+
+		outfp = strcmp( argv[2], "-") == 0 ? stdout : fopen( argv[2], "wb");
+		if (outfp == NULL)
+		{
+			fprintf( stderr, "Error: cannot open file [%s]\n", argv[2]);
+			ret = 1;
+		}
+		else
+		{
+			if (!ret && (fwrite( DICT_FILE_MAGIC, 1, 2, outfp) != 2
+				|| fwrite( encoded, 1, encoded_bytes, outfp) != (size_t)encoded_bytes)) ret = 1;
+			if (close_encoded( outfp) < 0) ret = 1;
+			if (ret) fprintf( stderr, "Error: cannot write file [%s]\n", argv[2]);
+		}
+
+		if (!ret) print_ratio( info, input.size, 2 + encoded_bytes);
+		if (!ret && show_stats)
+		{
+			stats.bytes_in = stats.symbols = input.size;
+			stats.bytes_out = 2 + encoded_bytes;
+			print_stats( stderr, &stats, "huffman_encoder");
+		}
+		free( encoded);
+		destroy_dict( dict);
+		close_input( &input);
+		return ret;
+	}
+
+	////////////////////////////////////////
+	// 블록 형식 : 블록마다 허프만 코드를 만들어 병렬로 인코딩
+	if (block_size > 0)
+	{
+		outfp = strcmp( argv[2], "-") == 0 ? stdout : fopen( argv[2], "wb");
+		if (outfp == NULL)
+		{
+			fprintf( stderr, "Error: cannot open file [%s]\n", argv[2]);
+			close_input( &input);
+			return 1;
+		}
+
+		stats_phase( &stats, "encode");
+		long long encoded_bytes = block_encoding( input.data, input.size, outfp, block_size, max_len, streams | (checksum ? BLOCK_CHECKSUM : 0), nthreads);
+
+		stats_phase( &stats, "close");
+		if (close_encoded( outfp) < 0)
+		{
+			fprintf( stderr, "Error: cannot write file [%s]\n", argv[2]);
+			close_input( &input);
+			return 1;
+		}
+		if (encoded_bytes < 0)
+		{
+			fprintf( stderr, "Error: cannot encode blocks with max code length %d\n", max_len);
+			close_input( &input);
+			return 1;
+		}
+		print_ratio( info, input.size, encoded_bytes);
+		if (show_stats)
+		{
+			stats.bytes_in = stats.symbols = input.size;
+			stats.bytes_out = encoded_bytes;
+			print_stats( stderr, &stats, "huffman_encoder");
+		}
+		close_input( &input);
+		return 0;
+	}
+
+	////////////////////////////////////////
+	// LZ77 : 앞에 나온 문자열과 같은 부분을 (거리, 길이)로 바꾼 다음 허프만 코드로 인코딩
+	if (lz_level > 0)
+	{
+		outfp = strcmp( argv[2], "-") == 0 ? stdout : fopen( argv[2], "wb");
+		if (outfp == NULL)
+		{
+			fprintf( stderr, "Error: cannot open file [%s]\n", argv[2]);
+			close_input( &input);
+			return 1;
+		}
+
+		stats_phase( &stats, "encode");
+		long long encoded_bytes = lz_encoding( input.data, input.size, outfp, lz_level, window_log);
+
+		stats_phase( &stats, "close");
+		if (close_encoded( outfp) < 0)
+		{
+			fprintf( stderr, "Error: cannot write file [%s]\n", argv[2]);
+			close_input( &input);
+			return 1;
+		}
+		if (encoded_bytes < 0)
+		{
+			fprintf( stderr, "Error: cannot encode with LZ77\n");
+			close_input( &input);
+			return 1;
+		}
+		print_ratio( info, input.size, encoded_bytes);
+		if (show_stats)
+		{
+			stats.bytes_in = stats.symbols = input.size;
+			stats.bytes_out = encoded_bytes;
+			print_stats( stderr, &stats, "huffman_encoder");
+		}
+		close_input( &input);
+		return 0;
+	}
+
+	////////////////////////////////////////
+	// 16비트 심볼 : 2바이트 단위의 심볼별 허프만 코드로 인코딩
+	if (wide)
+	{
+		outfp = strcmp( argv[2], "-") == 0 ? stdout : fopen( argv[2], "wb");
+		if (outfp == NULL)
+		{
+			fprintf( stderr, "Error: cannot open file [%s]\n", argv[2]);
+			close_input( &input);
+			return 1;
+		}
+
+		stats_phase( &stats, "encode");
+		long long encoded_bytes = encoding_wide( input.data, input.size, max_len, outfp);
+
+		stats_phase( &stats, "close");
+		if (close_encoded( outfp) < 0)
+		{
+			fprintf( stderr, "Error: cannot write file [%s]\n", argv[2]);
+			close_input( &input);
+			return 1;
+		}
+		if (encoded_bytes < 0)
+		{
+			fprintf( stderr, "Error: too many symbols for max code length %d\n", max_len);
+			close_input( &input);
+			return 1;
+		}
+		print_ratio( info, input.size, encoded_bytes);
+		if (show_stats)
+		{
+			stats.bytes_in = input.size;
+			stats.symbols = input.size / 2;
+			stats.bytes_out = encoded_bytes;
+			print_stats( stderr, &stats, "huffman_encoder");
+		}
+		close_input( &input);
+		return 0;
+	}
+
+	////////////////////////////////////////
+	// order-1 : 앞 문자(문맥)별 허프만 코드로 인코딩
+	if (order == 1)
+	{
+		outfp = strcmp( argv[2], "-") == 0 ? stdout : fopen( argv[2], "wb");
+		if (outfp == NULL)
+		{
+			fprintf( stderr, "Error: cannot open file [%s]\n", argv[2]);
+			close_input( &input);
+			return 1;
+		}
+
+		stats_phase( &stats, "encode");
+		long long encoded_bytes = encoding_order1( input.data, input.size, max_len, outfp);
+
+		stats_phase( &stats, "close");
+		if (close_encoded( outfp) < 0)
+		{
+			fprintf( stderr, "Error: cannot write file [%s]\n", argv[2]);
+			close_input( &input);
+			return 1;
+		}
+		if (encoded_bytes < 0)
+		{
+			fprintf( stderr, "Error: too many symbols for max code length %d\n", max_len);
+			close_input( &input);
+			return 1;
+		}
+		print_ratio( info, input.size, encoded_bytes);
+		if (show_stats)
+		{
+			stats.bytes_in = stats.symbols = input.size;
+			stats.bytes_out = encoded_bytes;
+			print_stats( stderr, &stats, "huffman_encoder");
+		}
+		close_input( &input);
+		return 0;
+	}
+
+	// 텍스트 파일로부터 문자별 빈도 저장 (구간별로 나누어 병렬 처리)
+	stats_phase( &stats, "histogram");
+	count_chars_parallel( input.data, input.size, ch_freq, nthreads);
+	long long num_bytes = input.size;
 
 	// 문자별 빈도 출력 (only for debugging)
 	//print_char_freq( ch_freq);
 	
 	// 허프만 트리 생성
+	stats_phase( &stats, "tree");
 	huffman_tree = make_huffman_tree( ch_freq);
 	
-	// 허프만 코드 생성
-	make_huffman_code( huffman_tree, codes);
+	// 허프만 트리로부터 코드 길이를 구함
+	stats_phase( &stats, "code");
+	get_code_lengths( huffman_tree, lengths);
+
+	// 코드 길이 제한 (트리가 제한보다 깊은 경우에만 package-merge 사용)
+	if (max_len > 0)
+	{
+		double free_bits = code_bits( ch_freq, lengths);
+		int free_max = max_code_length( lengths);
+
+		if (free_max > max_len && get_limited_code_lengths( ch_freq, max_len, lengths) < 0)
+		{
+			fprintf( stderr, "Error: too many symbols for max code length %d\n", max_len);
+			destroyTree( huffman_tree);
+			close_input( &input);
+			return 1;
+		}
+
+		stats_end( &stats);
+		double limited_bits = code_bits( ch_freq, lengths);
+		fprintf( stderr, "max code length = %d (unconstrained %d)\n", max_code_length( lengths), free_max);
+		fprintf( stderr, "ratio cost of length limit = %.4f%% (%.0f more bits)\n",
+			free_bits > 0 ? (limited_bits - free_bits) / free_bits * 100 : 0.0, limited_bits - free_bits);
+	}
+
+	// 허프만 코드 생성 (정규 코드)
+	stats_phase( &stats, "code");
+	if (make_canonical_code( lengths, codes) < 0)
+	{
+		fprintf( stderr, "Error: invalid code lengths\n");
+		destroyTree( huffman_tree);
+		close_input( &input);
+		return 1;
+	}
+	stats_end( &stats);
 	
-	// 허프만 코드 출력 (stdout)
-	print_huffman_code( codes);
+	// 허프만 코드 출력 (-c, stdout, 출력 파일이 표준 출력이면 생략)
+	if (print_codes && info == stdout) print_huffman_code( codes);
 
 	////////////////////////////////////////
-	// 입력: 텍스트 파일
-	infp = fopen( argv[1], "rt");
-	
 	// 출력: 바이너리 코드
-	outfp = fopen( argv[2], "wb");
-
-	// 허프만코드를 이용하여 입력 파일을 인코딩(압축)
-	int encoded_bytes = encoding( codes, ch_freq, infp, outfp);
+	outfp = strcmp( argv[2], "-") == 0 ? stdout : fopen( argv[2], "wb");
+	if (outfp == NULL)
+	{
+		fprintf( stderr, "Error: cannot open file [%s]\n", argv[2]);
+		destroyTree( huffman_tree);
+		close_input( &input);
+		return 1;
+	}
 
-	fclose( infp);
-	fclose( outfp);
+	// 허프만코드를 이용하여 메모리에 올린 입력을 인코딩(압축), 동기점 인덱스를 함께 저장
+	stats_phase( &stats, "encode");
+	long long encoded_bytes = sync_interval > 0 ? encoding_indexed( codes, input.data, input.size, sync_interval, outfp)
+		: encoding_mem( codes, input.data, input.size, outfp);
 
-	// 허프만 코드 메모리 해제
-	free_huffman_code( codes);
+	stats_phase( &stats, "close");
+	int write_error = close_encoded( outfp) < 0;
+	close_input( &input);
+	stats_end( &stats);
 
 	// 허프만 트리 메모리 해제
 	destroyTree( huffman_tree);
+
+	if (write_error)
+	{
+		fprintf( stderr, "Error: cannot write file [%s]\n", argv[2]);
+		return 1;
+	}
 	
 	////////////////////////////////////////
-	printf( "# of bytes of the original text = %d\n", num_bytes);
-	printf( "# of bytes of the compressed text = %d\n", encoded_bytes);
-	printf( "compression ratio = %.2f\n", ((float)num_bytes - encoded_bytes) / num_bytes * 100);
+	print_ratio( info, num_bytes, encoded_bytes);
+	if (show_stats)
+	{
+		stats.bytes_in = stats.symbols = num_bytes;
+		stats.bytes_out = encoded_bytes;
+		stats.max_code_len = max_code_length( lengths);
+		for (int i = 0; i < 256; i++) stats.alphabet += lengths[i] > 0;
+		print_stats( stderr, &stats, "huffman_encoder");
+	}
 	
 	return 0;
 }
@@ -0,0 +1,73 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <unistd.h>
+
+#include "huffman.h"
+
+////////////////////////////////////////////////////////////////////////////////
+// 표본 파일들로 사전(미리 학습한 코드 표)을 만들어 저장
+// -L max-len : 코드 길이의 최대값 (기본값: 제한 없음)
+// argv[optind] : 사전 파일
+// argv[optind+1] ... : 표본 파일 ("-"이면 표준 입력)
+int main( int argc, char **argv)
+{
+	FILE *fp;
+	tInput input; // 메모리에 올린 표본 파일
+	long long ch_freq[256] = {0,}; // 모든 표본의 문자별 빈도
+	long long num_bytes = 0; // 모든 표본의 바이트 수
+	tDict *dict; // 사전
+	int max_len = 0; // 코드 길이 제한 (0이면 제한 없음)
+	int opt, bad = 0, i;
+
+	while ((opt = getopt( argc, argv, "L:")) != -1)
+	{
+		if (opt == 'L')
+		{
+			max_len = atoi( optarg);
+			if (max_len < 8 || max_len > MAX_CODE_LEN) bad = 1; // 256개의 문자에 모두 코드가 있어야 함
+		}
+		else bad = 1;
+	}
+
+	if (bad || argc - optind < 2)
+	{
+		fprintf( stderr, "%s [-L max-len(8-%d)] dict-file sample-file...\n", argv[0], MAX_CODE_LEN);
+		return 1;
+	}
+
+	// 표본 파일마다 빈도를 더함
+	for (i = optind + 1; i < argc; i++)
+	{
+		if (open_input( argv[i], &input) < 0)
+		{
+			fprintf( stderr, "Error: cannot open file [%s]\n", argv[i]);
+			return 1;
+		}
+		count_chars( input.data, input.size, ch_freq);
+		num_bytes += input.size;
+		close_input( &input);
+	}
+
+	dict = train_dict( ch_freq, max_len);
+	if (dict == NULL)
+	{
+		fprintf( stderr, "Error: cannot train dictionary with max code length %d\n", max_len);
+		return 1;
+	}
+
+	fp = fopen( argv[optind], "wb");
+	if (fp == NULL || write_dict( fp, dict) < 0)
+	{
+		fprintf( stderr, "Error: cannot write file [%s]\n", argv[optind]);
+		if (fp) fclose( fp);
+		destroy_dict( dict);
+		return 1;
+	}
+	fclose( fp);
+
+	printf( "dictionary id = %08x\n", dict_id( dict));
+	printf( "# of bytes of the samples = %lld\n", num_bytes);
+
+	destroy_dict( dict);
+	return 0;
+}
@@ -0,0 +1,535 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "huffman.h"
+#include "lz77.h"
+
+#define HASH_LOG	17	// 해시 테이블 크기의 log2
+
+// 일치 탐색의 정도별 설정 (zlib의 설정과 비슷하게)
+static const struct
+{
+	int	chain;	// 해시 체인에서 살펴볼 후보 수
+	int	nice;	// 이 길이 이상의 일치를 찾으면 탐색을 멈춤
+	int	lazy;	// 일치가 이 길이보다 짧으면 다음 위치에서 더 긴 일치를 찾음 (lazy matching, 0이면 하지 않음)
+	int	good;	// 일치가 이 길이 이상이면 다음 위치에서는 후보를 1/4만 살펴봄
+} levels[LZ_MAX_LEVEL + 1] =
+{
+	{ 0, 0, 0, 0 },
+	{ 4, 16, 0, 0 }, { 8, 16, 0, 0 }, { 32, 32, 0, 0 },
+	{ 16, 16, 4, 4 }, { 32, 32, 16, 8 }, { 128, 128, 16, 8 },
+	{ 256, 128, 32, 8 }, { 1024, 258, 128, 32 }, { 4096, 1024, 258, 32 },
+};
+
+// 해시 체인으로 일치를 찾는 상태
+typedef struct
+{
+	const unsigned char	*data;	// 입력 전체
+	size_t				size;
+	size_t				window;	// 창 크기 (2의 거듭제곱)
+	uint32_t			*head;	// 해시값별 마지막 위치 + 1의 하위 32비트 (0이면 없음)
+	uint32_t			*prev;	// 위치(% window)별 같은 해시값의 이전 위치 + 1의 하위 32비트
+	size_t				next;	// 다음에 해시 체인에 넣을 위치
+	int					chain;
+	int					nice;
+} tMatcher;
+
+// 추가 비트를 쓰거나 읽는 비트열
+typedef struct
+{
+	unsigned char	*buf;
+	size_t			pos;	// 쓴(읽은) 바이트 수
+	size_t			size;	// 읽을 수 있는 바이트 수
+	uint64_t		acc;	// 아직 쓰지 않은(읽고 남은) 비트
+	int				nacc;
+	int				error;	// 읽기 : 비트열의 끝을 넘어 읽은 경우
+} tBits;
+
+////////////////////////////////////////////////////////////////////////////////
+static void put_u32( unsigned char *p, uint32_t v)
+{
+	int i;
+	for (i = 0; i < 4; i++) p[i] = v >> (8 * i);
+}
+
+static void put_u64( unsigned char *p, uint64_t v)
+{
+	int i;
+	for (i = 0; i < 8; i++) p[i] = v >> (8 * i);
+}
+
+static uint32_t get_u32( const unsigned char *p)
+{
+	return p[0] | (p[1] << 8) | (p[2] << 16) | ((uint32_t)p[3] << 24);
+}
+
+static uint64_t get_u64( const unsigned char *p)
+{
+	return get_u32( p) | ((uint64_t)get_u32( p + 4) << 32);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// 비트열에 value의 하위 n비트를 씀 (n <= 32)
+static void put_bits( tBits *b, uint32_t value, int n)
+{
+	b->acc = (b->acc << n) | value;
+	b->nacc += n;
+	while (b->nacc >= 8)
+	{
+		b->nacc -= 8;
+		b->buf[b->pos++] = b->acc >> b->nacc;
+	}
+}
+
+// 남은 비트를 출력 (마지막 바이트는 0으로 채움)
+static void flush_bits( tBits *b)
+{
+	if (b->nacc > 0) b->buf[b->pos++] = b->acc << (8 - b->nacc);
+	b->nacc = 0;
+}
+
+// 비트열에서 n비트를 읽음 (n <= 32)
+static uint32_t get_bits( tBits *b, int n)
+{
+	while (b->nacc < n)
+	{
+		if (b->pos >= b->size)
+		{
+			b->error = 1;
+			return 0;
+		}
+		b->acc = (b->acc << 8) | b->buf[b->pos++];
+		b->nacc += 8;
+	}
+	b->nacc -= n;
+	return (b->acc >> b->nacc) & (((uint64_t)1 << n) - 1);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// 값(v)의 코드 : 16 미만은 그대로, 그 이상은 최상위 비트 위치와 그 아래 비트 하나로 만든 코드
+// 나머지 비트는 추가 비트로 씀
+static unsigned char value_code( uint32_t v, tBits *extra)
+{
+	int n;
+
+	if (v < 16) return v;
+	n = 31 - __builtin_clz( v);
+	put_bits( extra, v & ((1u << (n - 1)) - 1), n - 1);
+	return 16 + (n - 4) * 2 + ((v >> (n - 1)) & 1);
+}
+
+// 코드와 추가 비트로부터 값을 구함
+static uint32_t code_value( unsigned char code, tBits *extra)
+{
+	int n;
+
+	if (code < 16) return code;
+	n = (code - 16) / 2 + 4;
+	if (n > 31)
+	{
+		extra->error = 1;
+		return 0;
+	}
+	return ((uint32_t)1 << n) | ((uint32_t)(code & 1) << (n - 1)) | get_bits( extra, n - 1);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// p에서 시작하는 4바이트의 해시값
+static inline uint32_t hash4( const unsigned char *p)
+{
+	uint32_t v = p[0] | (p[1] << 8) | (p[2] << 16) | ((uint32_t)p[3] << 24);
+	return (v * 2654435761u) >> (32 - HASH_LOG);
+}
+
+// a와 b가 앞에서부터 같은 바이트 수 (최대 max)
+static inline size_t match_length( const unsigned char *a, const unsigned char *b, size_t max)
+{
+	size_t len = 0;
+	uint64_t x, y;
+
+	// 8바이트씩 비교하고 다른 8바이트 안에서는 바이트 단위로
+	while (len + 8 <= max)
+	{
+		memcpy( &x, a + len, 8);
+		memcpy( &y, b + len, 8);
+		if (x != y) break;
+		len += 8;
+	}
+	while (len < max && a[len] == b[len]) len++;
+	return len;
+}
+
+// 위치(pos)를 해시 체인에 넣음 (이미 넣은 위치는 다시 넣지 않음)
+static inline void insert_pos( tMatcher *m, size_t pos)
+{
+	uint32_t h;
+
+	if (pos < m->next || pos + 4 > m->size) return;
+	h = hash4( m->data + pos);
+	m->prev[pos & (m->window - 1)] = m->head[h];
+	m->head[h] = (uint32_t)(pos + 1);
+	m->next = pos + 1;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// 위치(pos)에서 end 이전까지 가장 긴 일치를 해시 체인에서 찾고 pos를 해시 체인에 넣음
+// dist : 일치하는 문자열까지의 거리를 저장
+// return value : 일치 길이, LZ_MIN_MATCH보다 짧으면 0
+static size_t find_match( tMatcher *m, size_t pos, size_t end, size_t *dist)
+{
+	const unsigned char *data = m->data;
+	size_t max_len = end - pos;
+	size_t best = LZ_MIN_MATCH - 1;
+	uint32_t cand = m->head[hash4( data + pos)];
+	int chain = m->chain;
+
+	insert_pos( m, pos);
+
+	// 후보는 위치가 작아지는 순서, 창 밖의 후보에서 멈춤
+	// 위치는 하위 32비트만 저장하므로 거리를 32비트로 계산 (창보다 오래된 후보가 창 안으로 보일 수 있지만 내용을 비교하므로 틀리지 않음)
+	while (cand != 0 && chain-- > 0)
+	{
+		size_t d = (uint32_t)((uint32_t)(pos + 1) - cand);
+		size_t c;
+
+		if (d == 0 || d >= m->window || d > pos) break;
+		c = pos - d;
+
+		// 지금까지의 최대 길이 위치의 바이트가 다르면 더 길 수 없음
+		if (data[c + best] == data[pos + best])
+		{
+			size_t len = match_length( data + c, data + pos, max_len);
+
+			if (len > best)
+			{
+				best = len;
+				*dist = d;
+				if (len >= (size_t)m->nice || len == max_len) break;
+			}
+		}
+		cand = m->prev[c & (m->window - 1)];
+	}
+	return best >= LZ_MIN_MATCH ? best : 0;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// 블록의 시퀀스와 스트림을 모으는 버퍼
+typedef struct
+{
+	unsigned char	*lits;		// 리터럴
+	size_t			nlit;
+	unsigned char	*codes[3];	// 리터럴 수, 일치 길이, 거리의 코드
+	size_t			nseq;
+	tBits			extra;		// 추가 비트
+} tSeqBuf;
+
+// 시퀀스 하나를 추가 : 리터럴(lit, ll 바이트) 다음에 거리 dist에서 ml 바이트 일치
+static void add_sequence( tSeqBuf *sb, const unsigned char *lit, size_t ll, size_t ml, size_t dist)
+{
+	memcpy( sb->lits + sb->nlit, lit, ll);
+	sb->nlit += ll;
+	sb->codes[0][sb->nseq] = value_code( ll, &sb->extra);
+	sb->codes[1][sb->nseq] = value_code( ml - LZ_MIN_MATCH, &sb->extra);
+	sb->codes[2][sb->nseq] = value_code( dist - 1, &sb->extra);
+	sb->nseq++;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// 스트림(src, n 바이트)을 버퍼 API로 압축하여 [압축 크기, compress_mem 형식]으로 출력 (비어 있으면 압축 크기 0)
+// return value : 출력한 바이트 수, 실패한 경우 -1
+static long long write_stream( tCodec *codec, const unsigned char *src, size_t n, unsigned char *buf, size_t cap, FILE *outfp)
+{
+	long long ret = n > 0 ? compress_mem( codec, src, n, buf + 4, cap - 4) : 0;
+
+	if (ret < 0) return -1;
+	put_u32( buf, ret);
+	fwrite( buf, 1, 4 + ret, outfp);
+	return 4 + ret;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// 메모리(data)에 있는 텍스트를 LZ77 형식으로 출력 파일(outfp)에 인코딩
+// 블록마다 시퀀스를 모은 다음 리터럴과 코드를 스트림별로 압축하여 출력
+// return value : 출력한 바이트 수, 실패한 경우 -1
+long long lz_encoding( const unsigned char *data, size_t size, FILE *outfp, int level, int window_log)
+{
+	unsigned char header[LZ_HEADER_SIZE];
+	size_t max_seq = LZ_BLOCK_SIZE / LZ_MIN_MATCH + 1;
+	size_t cap = compress_bound( LZ_BLOCK_SIZE) + 4;
+	unsigned char *buf;
+	long long written = 0;
+	tMatcher m;
+	tSeqBuf sb;
+	tCodec *codec;
+	size_t begin;
+	int i, error = 0;
+
+	if (level < 1 || level > LZ_MAX_LEVEL || window_log < LZ_MIN_WINDOW_LOG || window_log > LZ_MAX_WINDOW_LOG) return -1;
+
+	m.data = data;
+	m.size = size;
+	m.window = (size_t)1 << window_log;
+	m.head = (uint32_t *)calloc( (size_t)1 << HASH_LOG, sizeof(uint32_t));
+	m.prev = (uint32_t *)malloc( sizeof(uint32_t) * m.window);
+	m.next = 0;
+	m.chain = levels[level].chain;
+	m.nice = levels[level].nice;
+
+	sb.lits = (unsigned char *)malloc( LZ_BLOCK_SIZE);
+	for (i = 0; i < 3; i++) sb.codes[i] = (unsigned char *)malloc( max_seq);
+	sb.extra.buf = (unsigned char *)malloc( max_seq * 12 + 8); // 시퀀스마다 추가 비트는 최대 3 * 31비트
+	buf = (unsigned char *)malloc( cap);
+	codec = create_codec();
+
+	if (m.head == NULL || m.prev == NULL || sb.lits == NULL || sb.codes[0] == NULL || sb.codes[1] == NULL
+		|| sb.codes[2] == NULL || sb.extra.buf == NULL || buf == NULL || codec == NULL) error = 1;
+
+	// 파일 헤더
+	if (!error)
+	{
+		memcpy( header, LZ_MAGIC, 2);
+		header[2] = LZ_VERSION;
+		header[3] = window_log;
+		put_u64( header + 4, size);
+		fwrite( header, 1, LZ_HEADER_SIZE, outfp);
+		written += LZ_HEADER_SIZE;
+	}
+
+	for (begin = 0; begin < size && !error; begin += LZ_BLOCK_SIZE)
+	{
+		size_t end = size - begin < LZ_BLOCK_SIZE ? size : begin + LZ_BLOCK_SIZE;
+		size_t pos = begin, lit = begin;
+
+		sb.nlit = sb.nseq = 0;
+		sb.extra.pos = 0;
+		sb.extra.acc = 0;
+		sb.extra.nacc = 0;
+
+		// 시퀀스 : 일치를 찾으면 앞의 리터럴과 함께 추가하고 일치 다음으로 건너뜀
+		while (pos + LZ_MIN_MATCH <= end)
+		{
+			size_t dist = 0, len = find_match( &m, pos, end, &dist);
+
+			if (len == 0)
+			{
+				pos++;
+				continue;
+			}
+
+			// lazy matching : 다음 위치의 일치가 더 길면 현재 문자를 리터럴로 하고 다음 위치의 일치를 사용
+			while (len < (size_t)levels[level].lazy && pos + 1 + LZ_MIN_MATCH <= end)
+			{
+				size_t dist2 = 0, len2;
+
+				m.chain = len >= (size_t)levels[level].good ? levels[level].chain >> 2 : levels[level].chain;
+				len2 = find_match( &m, pos + 1, end, &dist2);
+				m.chain = levels[level].chain;
+				if (len2 <= len) break;
+				pos++;
+				len = len2;
+				dist = dist2;
+			}
+
+			add_sequence( &sb, data + lit, pos - lit, len, dist);
+			for (i = 1; (size_t)i < len; i++) insert_pos( &m, pos + i);
+			pos += len;
+			lit = pos;
+		}
+
+		// 블록 끝의 남은 리터럴 (다음 블록에서 찾을 수 있도록 해시 체인에 넣음)
+		memcpy( sb.lits + sb.nlit, data + lit, end - lit);
+		sb.nlit += end - lit;
+		for (; pos < end; pos++) insert_pos( &m, pos);
+		flush_bits( &sb.extra);
+
+		// 블록 헤더, 스트림 4개, 추가 비트
+		put_u32( buf, end - begin);
+		put_u32( buf + 4, sb.nseq);
+		put_u32( buf + 8, sb.nlit);
+		put_u32( buf + 12, sb.extra.pos);
+		fwrite( buf, 1, 16, outfp);
+		written += 16;
+
+		for (i = 0; i < 4 && !error; i++)
+		{
+			long long n = i == 0 ? write_stream( codec, sb.lits, sb.nlit, buf, cap, outfp)
+				: write_stream( codec, sb.codes[i - 1], sb.nseq, buf, cap, outfp);
+
+			if (n < 0) error = 1;
+			else written += n;
+		}
+
+		fwrite( sb.extra.buf, 1, sb.extra.pos, outfp);
+		written += sb.extra.pos;
+	}
+	if (ferror( outfp)) error = 1;
+
+	destroy_codec( codec);
+	free( buf);
+	free( sb.extra.buf);
+	for (i = 0; i < 3; i++) free( sb.codes[i]);
+	free( sb.lits);
+	free( m.prev);
+	free( m.head);
+
+	return error ? -1 : written;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// 메모리(data)에 올린 LZ77 형식 파일의 원본 크기
+// return value : 원본 바이트 수, -1 형식이 맞지 않는 경우
+long long lz_decoded_size( const unsigned char *data, size_t size)
+{
+	uint64_t raw_size;
+
+	if (size < LZ_HEADER_SIZE || memcmp( data, LZ_MAGIC, 2) != 0 || data[2] != LZ_VERSION) return -1;
+	if (data[3] < LZ_MIN_WINDOW_LOG || data[3] > LZ_MAX_WINDOW_LOG) return -1;
+	raw_size = get_u64( data + 4);
+	if (raw_size > (uint64_t)1 << 62) return -1;
+	return raw_size;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// 거리 dist 앞에서 len 바이트를 복사 (겹치는 경우 dist의 배수만큼씩 늘려가며 복사)
+static inline void copy_match( unsigned char *dst, size_t dist, size_t len)
+{
+	size_t done = 0;
+
+	if (dist >= len)
+	{
+		memcpy( dst, dst - dist, len);
+		return;
+	}
+	while (done < len)
+	{
+		size_t back = dist + done - (dist + done) % dist; // dist의 배수, 앞의 back 바이트는 이미 반복된 패턴
+		size_t n = back < len - done ? back : len - done;
+
+		memcpy( dst + done, dst + done - back, n);
+		done += n;
+	}
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// 메모리(data)에 올린 LZ77 형식 파일을 디코딩하여 out(원본 크기)에 저장
+// 블록마다 스트림 4개를 버퍼 API로 해제한 다음 시퀀스대로 리터럴과 일치를 복사
+// return value : 0 성공, -1 형식이 맞지 않는 경우
+int lz_decoding( const unsigned char *data, size_t size, unsigned char *out, size_t out_size)
+{
+	size_t max_seq = LZ_BLOCK_SIZE / LZ_MIN_MATCH + 1;
+	long long raw_size = lz_decoded_size( data, size);
+	const unsigned char *p = data + LZ_HEADER_SIZE;
+	size_t avail = size - LZ_HEADER_SIZE;
+	unsigned char *lits, *codes[3];
+	size_t window, pos = 0;
+	tCodec *codec;
+	int i, error = 0;
+
+	if (raw_size < 0 || (uint64_t)raw_size != out_size) return -1;
+	window = (size_t)1 << data[3];
+
+	lits = (unsigned char *)malloc( LZ_BLOCK_SIZE);
+	for (i = 0; i < 3; i++) codes[i] = (unsigned char *)malloc( max_seq);
+	codec = create_codec();
+	if (lits == NULL || codes[0] == NULL || codes[1] == NULL || codes[2] == NULL || codec == NULL) error = 1;
+
+	while (pos < out_size && !error)
+	{
+		size_t braw, nseq, nlit, nextra, end, k;
+		const unsigned char *lit, *lit_end;
+		tBits extra;
+
+		// 블록 헤더
+		if (avail < 16)
+		{
+			error = 1;
+			break;
+		}
+		braw = get_u32( p);
+		nseq = get_u32( p + 4);
+		nlit = get_u32( p + 8);
+		nextra = get_u32( p + 12);
+		p += 16;
+		avail -= 16;
+		if (braw == 0 || braw > LZ_BLOCK_SIZE || braw > out_size - pos || nseq > braw / LZ_MIN_MATCH || nlit > braw)
+		{
+			error = 1;
+			break;
+		}
+
+		// 스트림 4개 : 리터럴, 리터럴 수 코드, 일치 길이 코드, 거리 코드
+		for (i = 0; i < 4 && !error; i++)
+		{
+			size_t count = i == 0 ? nlit : nseq;
+			unsigned char *dst = i == 0 ? lits : codes[i - 1];
+			size_t csize = avail >= 4 ? get_u32( p) : 0;
+
+			if (avail < 4 || csize > avail - 4) error = 1;
+			else if (count == 0 ? csize != 0 : decompress_mem( codec, p + 4, csize, dst, count) != (long long)count) error = 1;
+			else
+			{
+				p += 4 + csize;
+				avail -= 4 + csize;
+			}
+		}
+		if (error || nextra > avail)
+		{
+			error = 1;
+			break;
+		}
+
+		// 추가 비트
+		extra.buf = (unsigned char *)p;
+		extra.pos = 0;
+		extra.size = nextra;
+		extra.acc = 0;
+		extra.nacc = 0;
+		extra.error = 0;
+		p += nextra;
+		avail -= nextra;
+
+		// 시퀀스대로 리터럴과 일치를 복사
+		end = pos + braw;
+		lit = lits;
+		lit_end = lits + nlit;
+		for (k = 0; k < nseq; k++)
+		{
+			size_t ll = code_value( codes[0][k], &extra);
+			size_t ml = code_value( codes[1][k], &extra) + (size_t)LZ_MIN_MATCH;
+			size_t dist = code_value( codes[2][k], &extra) + (size_t)1;
+
+			if (extra.error || ll > (size_t)(lit_end - lit) || ll > end - pos)
+			{
+				error = 1;
+				break;
+			}
+			memcpy( out + pos, lit, ll);
+			lit += ll;
+			pos += ll;
+
+			if (dist > pos || dist > window || ml > end - pos)
+			{
+				error = 1;
+				break;
+			}
+			copy_match( out + pos, dist, ml);
+			pos += ml;
+		}
+
+		// 남은 리터럴로 블록 끝까지
+		if (!error && (size_t)(lit_end - lit) == end - pos)
+		{
+			memcpy( out + pos, lit, lit_end - lit);
+			pos = end;
+		}
+		else error = 1;
+	}
+	if (avail != 0) error = 1;
+
+	destroy_codec( codec);
+	for (i = 0; i < 3; i++) free( codes[i]);
+	free( lits);
+
+	return error ? -1 : 0;
+}
@@ -0,0 +1,53 @@
+#ifndef LZ77_H
+#define LZ77_H
+
+#include <stdio.h>
+#include <stdint.h>
+
+#include "huffman.h"
+
+////////////////////////////////////////////////////////////////////////////////
+// LZ77 형식 : 앞에 나온 문자열과 같은 부분을 (거리, 길이)로 바꾼 다음 허프만 코드로 인코딩
+// 입력을 블록으로 나누어 블록마다 시퀀스 [리터럴 수, 일치 길이, 거리]를 구하고
+// 리터럴과 세 값의 코드는 각각 따로 버퍼 API(compress_mem)의 허프만 코드로, 코드의 추가 비트는 그대로 저장
+// 일치하는 문자열은 이전 블록에 있어도 됨 (창 크기 이내)
+//
+// [파일 헤더]   "HZ", 버전(1), 창 크기의 log2(1), 원본 크기(8)
+// [블록] ...    원본 크기(4), 시퀀스 수(4), 리터럴 수(4), 추가 비트 바이트 수(4),
+//               [압축 크기(4), compress_mem 형식] x 4 (리터럴, 리터럴 수 코드, 일치 길이 코드, 거리 코드, 비어 있으면 압축 크기 0),
+//               추가 비트
+//               각 시퀀스 : 리터럴 수만큼 리터럴을 복사한 다음 거리만큼 앞에서 일치 길이만큼 복사
+//               마지막 시퀀스 다음의 남은 리터럴은 블록 끝까지 복사
+// 정수는 모두 little-endian
+//
+// 값의 코드 : 16 미만은 값 그대로, 그 이상은 최상위 비트 위치와 그 아래 비트 하나로 만든 코드 + 나머지 비트 (추가 비트)
+
+#define LZ_MAGIC			"HZ"
+#define LZ_VERSION			1
+#define LZ_HEADER_SIZE		12		// 파일 헤더의 크기
+
+#define LZ_BLOCK_SIZE		(1 << 20)	// 블록 크기
+#define LZ_MIN_MATCH		4			// 최소 일치 길이
+
+#define LZ_MIN_WINDOW_LOG		10
+#define LZ_MAX_WINDOW_LOG		24
+#define LZ_DEFAULT_WINDOW_LOG	16	// 창 크기 64KB (창이 크면 해시 체인의 후보가 캐시에 없어 느려짐)
+
+#define LZ_MAX_LEVEL		9
+#define LZ_DEFAULT_LEVEL	6
+
+// 메모리(data)에 있는 텍스트를 LZ77 형식으로 출력 파일(outfp)에 인코딩
+// level : 일치 탐색의 정도 (1 : 빠름 ~ LZ_MAX_LEVEL : 압축률 높음), 해시 체인에서 살펴볼 후보 수와 lazy matching을 정함
+// window_log : 거리의 최대값(창 크기)의 log2 (LZ_MIN_WINDOW_LOG ~ LZ_MAX_WINDOW_LOG)
+// return value : 출력한 바이트 수, 실패한 경우 -1
+long long lz_encoding( const unsigned char *data, size_t size, FILE *outfp, int level, int window_log);
+
+// 메모리(data)에 올린 LZ77 형식 파일의 원본 크기
+// return value : 원본 바이트 수, -1 형식이 맞지 않는 경우
+long long lz_decoded_size( const unsigned char *data, size_t size);
+
+// 메모리(data)에 올린 LZ77 형식 파일을 디코딩하여 out(원본 크기)에 저장
+// return value : 0 성공, -1 형식이 맞지 않는 경우
+int lz_decoding( const unsigned char *data, size_t size, unsigned char *out, size_t out_size);
+
+#endif
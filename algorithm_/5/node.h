@@ -1,12 +1,27 @@
 #ifndef NODE_H
 #define NODE_H
 
+#include <stdint.h>
+
+// 자식이 없음을 나타내는 노드 번호 (노드 풀의 0번 노드는 사용하지 않음)
+#define NO_CHILD	0
+
 typedef struct Node 
 { 
+	long long		freq; 	// 빈도
+	uint16_t		left;	// 왼쪽 서브트리의 노드 번호 (노드 풀의 index)
+	uint16_t		right;	// 오른쪽 서브트리의 노드 번호
 	unsigned char	data;	// 문자	
-	int				freq; 	// 빈도
-	struct Node 	*left;	// 왼쪽 서브트리 포인터
-	struct Node 	*right; // 오른쪽 서브트리 포인터
 } tNode;
 
+// 허프만 트리
+// 모든 노드를 하나의 배열(노드 풀)에 저장하고 자식은 노드 번호로 가리킴
+typedef struct
+{
+	tNode	*nodes;		// 노드 풀 (트리와 함께 한번에 할당)
+	int		count;		// 사용한 노드 수 (0번 노드 포함)
+	int		capacity;	// 노드 풀의 크기
+	int		root;		// root 노드의 번호
+} tTree;
+
 #endif
@@ -0,0 +1,79 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <pthread.h>
+#include <unistd.h>
+
+#include "parallel.h"
+
+// 스레드들이 공유하는 작업 정보
+typedef struct
+{
+	int				n;		// 전체 작업 수
+	int				next;	// 다음에 실행할 작업 번호
+	pthread_mutex_t	lock;
+	void			(*work)( void *arg, int index);
+	void			*arg;
+} tPool;
+
+////////////////////////////////////////////////////////////////////////////////
+// 남은 작업이 없을 때까지 작업 번호를 하나씩 받아서 실행
+static void *worker( void *p)
+{
+	tPool *pool = p;
+	int index;
+	
+	while (1)
+	{
+		pthread_mutex_lock( &pool->lock);
+		index = pool->next++;
+		pthread_mutex_unlock( &pool->lock);
+		
+		if (index >= pool->n) break;
+		pool->work( pool->arg, index);
+	}
+	return 0;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// 0부터 n-1까지의 작업을 nthreads개의 스레드가 나누어 실행
+// 호출한 스레드도 작업에 참여
+void parallel_for( int n, int nthreads, void (*work)( void *arg, int index), void *arg)
+{
+	tPool pool;
+	pthread_t *threads;
+	int i, started = 0;
+	
+	if (nthreads > n) nthreads = n;
+	if (nthreads < 1) nthreads = 1;
+	
+	pool.n = n;
+	pool.next = 0;
+	pool.work = work;
+	pool.arg = arg;
+	pthread_mutex_init( &pool.lock, 0);
+	
+	threads = (pthread_t *)malloc( sizeof(pthread_t) * nthreads);
+	for (i = 1; i < nthreads; i++)
+	{
+		if (pthread_create( &threads[started], 0, worker, &pool) == 0) started++;
+	}
+	
+	worker( &pool);
+	
+	for (i = 0; i < started; i++)
+	{
+		pthread_join( threads[i], 0);
+	}
+	
+	free( threads);
+	pthread_mutex_destroy( &pool.lock);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// 사용 가능한 CPU 코어 수
+int default_threads( void)
+{
+	long n = sysconf( _SC_NPROCESSORS_ONLN);
+	
+	return n > 0 ? (int)n : 1;
+}
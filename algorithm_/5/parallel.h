@@ -0,0 +1,13 @@
+#ifndef PARALLEL_H
+#define PARALLEL_H
+
+////////////////////////////////////////////////////////////////////////////////
+// 0부터 n-1까지의 작업을 nthreads개의 스레드가 나누어 실행
+// 각 스레드는 다음 작업 번호를 받아 work( arg, index)를 호출
+// 모든 작업이 끝나면 리턴
+void parallel_for( int n, int nthreads, void (*work)( void *arg, int index), void *arg);
+
+// 사용 가능한 CPU 코어 수
+int default_threads( void);
+
+#endif
@@ -0,0 +1,117 @@
+#include <stdio.h>
+#include <string.h>
+#include <time.h>
+#include <sys/resource.h>
+
+#include "stats.h"
+
+////////////////////////////////////////////////////////////////////////////////
+// 현재 시각 (초)
+static double now( void)
+{
+	struct timespec ts;
+	
+	clock_gettime( CLOCK_MONOTONIC, &ts);
+	return ts.tv_sec + ts.tv_nsec * 1e-9;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// 카운터를 0으로 초기화
+void stats_init( tStats *st)
+{
+	memset( st, 0, sizeof(tStats));
+	st->current = -1;
+	st->start = now();
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// 진행 중인 단계를 끝냄
+void stats_end( tStats *st)
+{
+	if (st->current < 0) return;
+	
+	st->phases[st->current].seconds += now() - st->begin;
+	st->current = -1;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// 진행 중인 단계를 끝내고 새 단계(name)를 시작
+// 같은 이름의 단계가 있으면 시간을 더함 (단계 순서는 처음 시작한 순서)
+void stats_phase( tStats *st, const char *name)
+{
+	int i;
+	
+	stats_end( st);
+	for (i = 0; i < st->nphases; i++)
+	{
+		if (strcmp( st->phases[i].name, name) == 0) break;
+	}
+	if (i == st->nphases)
+	{
+		if (st->nphases == MAX_PHASES) return;
+		st->phases[i].name = name;
+		st->phases[i].seconds = 0;
+		st->nphases++;
+	}
+	st->current = i;
+	st->begin = now();
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// 커널이 센 입출력 호출 수 (/proc/self/io의 syscr, syscw)
+// return value : 0 성공, -1 읽을 수 없는 경우 (Linux가 아닌 경우 등)
+static int read_io_calls( long long *reads, long long *writes)
+{
+	FILE *fp = fopen( "/proc/self/io", "r");
+	char key[64];
+	long long value;
+	int found = 0;
+	
+	if (fp == NULL) return -1;
+	while (fscanf( fp, "%63[^:]: %lld\n", key, &value) == 2)
+	{
+		if (strcmp( key, "syscr") == 0)
+		{
+			*reads = value;
+			found++;
+		}
+		else if (strcmp( key, "syscw") == 0)
+		{
+			*writes = value;
+			found++;
+		}
+	}
+	fclose( fp);
+	return found == 2 ? 0 : -1;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// 프로그램 이름(program)과 함께 단계별 시간, 카운터, 입출력 호출 수, 최대 메모리 사용량을 JSON 한 줄로 출력
+// 시간은 밀리초, 처리량은 원본(심볼 수) 기준 MB/s, 모르는 입력 바이트 수(음수)는 null
+void print_stats( FILE *fp, tStats *st, const char *program)
+{
+	struct rusage usage;
+	long long reads = -1, writes = -1;
+	double total;
+	int i;
+	
+	stats_end( st);
+	total = now() - st->start;
+	read_io_calls( &reads, &writes);
+	getrusage( RUSAGE_SELF, &usage);
+	
+	fprintf( fp, "{\"program\": \"%s\", \"phases_ms\": {", program);
+	for (i = 0; i < st->nphases; i++)
+	{
+		fprintf( fp, "%s\"%s\": %.3f", i ? ", " : "", st->phases[i].name, st->phases[i].seconds * 1e3);
+	}
+	fprintf( fp, "}, \"total_ms\": %.3f", total * 1e3);
+	if (st->bytes_in >= 0) fprintf( fp, ", \"bytes_in\": %lld", st->bytes_in);
+	else fprintf( fp, ", \"bytes_in\": null");
+	fprintf( fp, ", \"bytes_out\": %lld, \"symbols\": %lld", st->bytes_out, st->symbols);
+	if (st->alphabet) fprintf( fp, ", \"alphabet\": %d", st->alphabet);
+	if (st->max_code_len) fprintf( fp, ", \"max_code_len\": %d", st->max_code_len);
+	fprintf( fp, ", \"mb_per_s\": %.1f", total > 0 ? st->symbols / total / 1e6 : 0.0);
+	fprintf( fp, ", \"read_calls\": %lld, \"write_calls\": %lld", reads, writes);
+	fprintf( fp, ", \"peak_rss_kb\": %ld}\n", usage.ru_maxrss);
+}
@@ -0,0 +1,47 @@
+#ifndef STATS_H
+#define STATS_H
+
+#include <stdio.h>
+
+////////////////////////////////////////////////////////////////////////////////
+// 단계별 시간과 카운터 (--stats)
+// 단계가 바뀔 때만 시각을 읽으므로 부담이 거의 없음
+// 입출력 호출 수는 커널이 세는 값(/proc/self/io)을 사용
+
+#define MAX_PHASES	16
+
+// 단계별 시간
+typedef struct
+{
+	const char	*name;		// 단계 이름
+	double		seconds;	// 걸린 시간 (초)
+} tPhase;
+
+typedef struct
+{
+	tPhase		phases[MAX_PHASES];
+	int			nphases;
+	int			current;		// 진행 중인 단계의 번호 (없으면 -1)
+	double		begin;			// 진행 중인 단계의 시작 시각
+	double		start;			// 첫 단계의 시작 시각
+	long long	bytes_in;		// 입력 바이트 수
+	long long	bytes_out;		// 출력 바이트 수
+	long long	symbols;		// 인코딩/디코딩한 심볼 수
+	int			alphabet;		// 코드가 있는 문자 수 (0이면 출력하지 않음)
+	int			max_code_len;	// 가장 긴 코드의 길이 (0이면 출력하지 않음)
+} tStats;
+
+// 카운터를 0으로 초기화
+void stats_init( tStats *st);
+
+// 진행 중인 단계를 끝내고 새 단계(name)를 시작
+// 같은 이름의 단계가 있으면 시간을 더함
+void stats_phase( tStats *st, const char *name);
+
+// 진행 중인 단계를 끝냄
+void stats_end( tStats *st);
+
+// 프로그램 이름(program)과 함께 단계별 시간, 카운터, 입출력 호출 수, 최대 메모리 사용량을 JSON 한 줄로 출력
+void print_stats( FILE *fp, tStats *st, const char *program);
+
+#endif